@@ -0,0 +1,339 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h> // qsort()
+#include <string.h>
+#include <time.h>
+
+#include "gameplay.h"
+#include "replay.h"
+#include "snapshot.h"
+
+#define BENCH_DEFAULT_WAVES_COUNT 7
+#define BENCH_MAXIMUM_WAVES_COUNT 14 // Waves double at a fixed spacing, so the last one alone spawns for hours of simulated time
+#define BENCH_SLACK_SECONDS_PER_WAVE 1 // On top of the longest a wave can take, for rounding to whole ticks
+
+#define SNAPSHOT_BENCH_TICKS_COUNT (10 * SIMULATION_TICKS_PER_SECOND)
+
+#define INTEGRATION_BENCH_TANKS_UPDATED_PER_KERNEL 200000000 // Split into however many passes each tank count needs
+
+typedef struct {
+	OutpostType type;
+	Vector2 position;
+} ScriptedOutpost;
+
+// Fixed layout so every run fights the same battle
+static ScriptedOutpost const scripted_outposts[] = {
+	{OUTPOST_SIMPLE, {500, 375}},
+	{OUTPOST_MORTAR, {800, 375}},
+	{OUTPOST_PIERCE, {1150, 375}},
+	{OUTPOST_SIMPLE, {400, 725}},
+	{OUTPOST_MORTAR, {900, 725}},
+	{OUTPOST_PIERCE, {1475, 550}},
+	{OUTPOST_SIMPLE, {1800, 600}},
+	{OUTPOST_MORTAR, {700, 1000}},
+};
+
+static double getSeconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static int compareDoubles(void const *a, void const *b)
+{
+	double difference = *(double const *) a - *(double const *) b;
+	return (difference > 0) - (difference < 0);
+}
+
+// Times every supported integration kernel on flat arrays, and checks each
+// against the scalar one bit for bit
+static int runIntegrationBench(void)
+{
+	static uint32_t const tanks_counts[] = {1000, 10000, 100000};
+
+	IntegrateKernel kernels[INTEGRATE_KERNELS_MAXIMUM_COUNT];
+	uint8_t kernels_count = getSupportedIntegrateKernels(kernels);
+	float const frame_time = SIMULATION_TICK_SECONDS;
+	int exit_status = 0;
+
+	printf("%-8s %-8s %12s %10s %s\n", "tanks", "kernel", "ns/tank", "speedup", "matches scalar");
+
+	for (uint8_t i = 0; i < sizeof tanks_counts / sizeof (uint32_t); i++) {
+		uint32_t tanks_count = tanks_counts[i];
+		uint32_t passes_count = INTEGRATION_BENCH_TANKS_UPDATED_PER_KERNEL / tanks_count;
+
+		float *initial_arrays = allocateAligned(3 * tanks_count * sizeof (float));
+		float *arrays = allocateAligned(3 * tanks_count * sizeof (float));
+		float *scalar_arrays = allocateAligned(3 * tanks_count * sizeof (float));
+
+		for (uint32_t j = 0; j < 3 * tanks_count; j++)
+			initial_arrays[j] = 1000.f * rand() / RAND_MAX - 500.f;
+
+		double scalar_seconds = 0.;
+		for (uint8_t k = 0; k < kernels_count; k++) {
+			memcpy(arrays, initial_arrays, 3 * tanks_count * sizeof (float));
+			float *positions = arrays;
+			float *velocities = arrays + tanks_count;
+			float const *accelerations = arrays + 2 * tanks_count;
+
+			double start_seconds = getSeconds();
+			for (uint32_t pass = 0; pass < passes_count; pass++)
+				kernels[k].function(positions, velocities, accelerations, tanks_count, frame_time);
+			double seconds = getSeconds() - start_seconds;
+
+			if (k == 0) {
+				scalar_seconds = seconds;
+				memcpy(scalar_arrays, arrays, 3 * tanks_count * sizeof (float));
+			}
+
+			bool matches = memcmp(arrays, scalar_arrays, 3 * tanks_count * sizeof (float)) == 0;
+			if (!matches)
+				exit_status = 1;
+
+			printf("%-8u %-8s %12.4f %9.2fx %s\n",
+				tanks_count,
+				kernels[k].name,
+				seconds * 1e9 / ((double) passes_count * tanks_count),
+				scalar_seconds / seconds,
+				matches ? "yes" : "NO"
+			);
+		}
+
+		free(initial_arrays);
+		free(arrays);
+		free(scalar_arrays);
+	}
+
+	return exit_status;
+}
+
+// Re-runs a log saved with `citadel --record`, as fast as possible, checking
+// every tick's checksum, so one real session can be timed before and after a change
+static int runReplayBench(char const *path)
+{
+	ReplayLog replay_log;
+	if (!loadReplayLog(&replay_log, path)) {
+		fprintf(stderr, "citadel-bench: can't replay %s\n", path);
+		return 1;
+	}
+
+	GameplayLogic gameplay_logic;
+	GameplayPhysics gameplay_physics;
+	GameplayDrawData gameplay_draw_data;
+	initGameplay(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, game_state_tanks_path_points, game_state_tanks_path_points_count, (Texture2D) {}, replay_log.seed);
+
+	float const tick_seconds = SIMULATION_TICK_SECONDS;
+	uint32_t ticks_count = replay_log.checksums_count;
+	double *tick_seconds_samples = malloc((ticks_count > 0 ? ticks_count : 1) * sizeof (double));
+	uint32_t next_command_index = 0;
+	uint32_t mismatches_count = 0;
+
+	double start_seconds = getSeconds();
+
+	for (uint32_t tick = 0; tick < ticks_count; tick++) {
+		// As the game does once a frame, so no timed tick has to grow storage
+		reserveGameplay(&gameplay_logic, &gameplay_physics, gameplay_logic.tanks_count + getPendingSpawnsCount(&gameplay_logic), gameplay_logic.outposts_count + 1);
+
+		double tick_start_seconds = getSeconds();
+
+		applyReplayCommands(&replay_log, &next_command_index, &gameplay_logic, &gameplay_physics, &gameplay_draw_data);
+		updateGameplayLogic(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, tick_seconds);
+		updateGameplayPhysics(&gameplay_physics, tick_seconds);
+		updateGameplayDrawData(&gameplay_draw_data, &gameplay_logic, &gameplay_physics, tick_seconds, 1.f);
+
+		tick_seconds_samples[tick] = getSeconds() - tick_start_seconds;
+
+		if (getGameplayChecksum(&gameplay_logic, &gameplay_physics) != replay_log.checksums[tick] && mismatches_count++ == 0)
+			fprintf(stderr, "citadel-bench: replay diverged at tick %u\n", tick);
+	}
+
+	double total_seconds = getSeconds() - start_seconds;
+
+	qsort(tick_seconds_samples, ticks_count, sizeof (double), compareDoubles);
+
+	printf("ticks:                  %u (%.1f simulated seconds)\n", ticks_count, ticks_count * tick_seconds);
+	printf("commands:               %u\n", replay_log.commands_count);
+	if (ticks_count > 0) {
+		printf("ticks/sec:              %.0f\n", ticks_count / total_seconds);
+		printf("p50 tick:               %.3f us\n", tick_seconds_samples[ticks_count / 2] * 1e6);
+		printf("p99 tick:               %.3f us\n", tick_seconds_samples[ticks_count * 99 / 100] * 1e6);
+	}
+	printf("mismatched ticks:       %u\n", mismatches_count);
+
+	free(tick_seconds_samples);
+	freeReplayLog(&replay_log);
+	return mismatches_count > 0;
+}
+
+// Times restoring a snapshot saved with --save-snapshot (or F5 in the game),
+// then a stretch of ticks from there, so a late wave can be profiled without
+// playing up to it
+static int runSnapshotBench(char const *path)
+{
+	GameplayLogic gameplay_logic;
+	GameplayPhysics gameplay_physics;
+	GameplayDrawData gameplay_draw_data;
+	initGameplay(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, game_state_tanks_path_points, game_state_tanks_path_points_count, (Texture2D) {}, 1);
+
+	double load_start_seconds = getSeconds();
+	if (!loadGameplaySnapshot(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, path)) {
+		fprintf(stderr, "citadel-bench: can't load %s\n", path);
+		return 1;
+	}
+	double load_seconds = getSeconds() - load_start_seconds;
+
+	printf("load:                   %.3f ms\n", load_seconds * 1e3);
+	printf("wave:                   %u\n", gameplay_logic.current_wave_number);
+	printf("tanks:                  %u\n", gameplay_logic.tanks_count);
+	printf("outposts:               %u\n", gameplay_logic.outposts_count);
+
+	float const tick_seconds = SIMULATION_TICK_SECONDS;
+	double *tick_seconds_samples = malloc(SNAPSHOT_BENCH_TICKS_COUNT * sizeof (double));
+
+	double start_seconds = getSeconds();
+
+	for (uint32_t tick = 0; tick < SNAPSHOT_BENCH_TICKS_COUNT; tick++) {
+		reserveGameplay(&gameplay_logic, &gameplay_physics, gameplay_logic.tanks_count + getPendingSpawnsCount(&gameplay_logic), gameplay_logic.outposts_count + 1);
+
+		double tick_start_seconds = getSeconds();
+
+		updateGameplayLogic(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, tick_seconds);
+		updateGameplayPhysics(&gameplay_physics, tick_seconds);
+		updateGameplayDrawData(&gameplay_draw_data, &gameplay_logic, &gameplay_physics, tick_seconds, 1.f);
+
+		tick_seconds_samples[tick] = getSeconds() - tick_start_seconds;
+	}
+
+	double total_seconds = getSeconds() - start_seconds;
+
+	qsort(tick_seconds_samples, SNAPSHOT_BENCH_TICKS_COUNT, sizeof (double), compareDoubles);
+
+	printf("ticks:                  %u (%.1f simulated seconds)\n", SNAPSHOT_BENCH_TICKS_COUNT, SNAPSHOT_BENCH_TICKS_COUNT * tick_seconds);
+	printf("ticks/sec:              %.0f\n", SNAPSHOT_BENCH_TICKS_COUNT / total_seconds);
+	printf("p50 tick:               %.3f us\n", tick_seconds_samples[SNAPSHOT_BENCH_TICKS_COUNT / 2] * 1e6);
+	printf("p99 tick:               %.3f us\n", tick_seconds_samples[SNAPSHOT_BENCH_TICKS_COUNT * 99 / 100] * 1e6);
+
+	free(tick_seconds_samples);
+	return 0;
+}
+
+// Every wave's pause and, with every gap at its longest, its spawning, then
+// the pause after the last one: the most ticks the scripted run can take
+static uint32_t getMaximumTicksCount(uint32_t waves_count)
+{
+	double seconds = 0.;
+	for (uint32_t i = 0; i <= waves_count; i++) {
+		WaveSpecification wave = getWaveSpecification(i);
+		seconds += wave.pause_seconds + BENCH_SLACK_SECONDS_PER_WAVE;
+		if (i < waves_count && wave.tanks_count > 0)
+			seconds += (wave.tanks_count - 1) * wave.spacing * (1.f + wave.spacing_jitter) / TANK_SPEED;
+	}
+	return seconds * SIMULATION_TICKS_PER_SECOND;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc > 1 && strcmp(argv[1], "--integration") == 0)
+		return runIntegrationBench();
+	if (argc > 2 && strcmp(argv[1], "--replay") == 0)
+		return runReplayBench(argv[2]);
+	if (argc > 2 && strcmp(argv[1], "--snapshot") == 0)
+		return runSnapshotBench(argv[2]);
+
+	uint32_t waves_count = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_WAVES_COUNT;
+	if (waves_count > BENCH_MAXIMUM_WAVES_COUNT) {
+		fprintf(stderr, "citadel-bench: clamping %u waves to %u\n", waves_count, BENCH_MAXIMUM_WAVES_COUNT);
+		waves_count = BENCH_MAXIMUM_WAVES_COUNT;
+	}
+	// Saved as soon as the last wave is all out, the scripted run's heaviest stretch
+	char const *snapshot_path = argc > 3 && strcmp(argv[2], "--save-snapshot") == 0 ? argv[3] : NULL;
+
+	GameplayLogic gameplay_logic;
+	GameplayPhysics gameplay_physics;
+	GameplayDrawData gameplay_draw_data;
+	initGameplay(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, game_state_tanks_path_points, game_state_tanks_path_points_count, (Texture2D) {}, 1);
+
+	// Every tank of every wave could be alive at once; keep allocation out of the timed ticks
+	uint32_t tanks_count = 0;
+	for (uint32_t i = 0; i < waves_count; i++)
+		tanks_count += getWaveSpecification(i).tanks_count;
+	reserveGameplay(&gameplay_logic, &gameplay_physics, tanks_count, sizeof scripted_outposts / sizeof (ScriptedOutpost));
+
+	for (uint8_t i = 0; i < sizeof scripted_outposts / sizeof (ScriptedOutpost); i++) {
+		if (!canOutpostBePlaced(&gameplay_logic, scripted_outposts[i].position)) {
+			fprintf(stderr, "citadel-bench: skipping unplaceable outpost %u\n", i);
+			continue;
+		}
+
+		addOutpost(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, scripted_outposts[i].type, scripted_outposts[i].position);
+	}
+
+	float const tick_seconds = SIMULATION_TICK_SECONDS;
+	uint32_t maximum_ticks_count = getMaximumTicksCount(waves_count);
+	double *tick_seconds_samples = malloc(maximum_ticks_count * sizeof (double));
+	if (tick_seconds_samples == NULL) {
+		fprintf(stderr, "citadel-bench: can't allocate %u tick samples\n", maximum_ticks_count);
+		return 1;
+	}
+	uint32_t ticks_count = 0;
+
+	uint32_t peak_tanks_count = 0;
+	uint32_t peak_outposts_count = gameplay_logic.outposts_count;
+	uint32_t peak_outpost_shot_animations_count = 0;
+	uint32_t peak_tank_shot_animations_count = 0;
+
+	double start_seconds = getSeconds();
+
+	// Run every wave to completion, plus the inter-wave pause after the last one
+	while (
+		!(gameplay_logic.current_wave_number >= waves_count && gameplay_logic.seconds_till_next_wave < 0.f) &&
+		ticks_count < maximum_ticks_count
+	) {
+		double tick_start_seconds = getSeconds();
+
+		updateGameplayLogic(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, tick_seconds);
+		updateGameplayPhysics(&gameplay_physics, tick_seconds);
+		updateGameplayDrawData(&gameplay_draw_data, &gameplay_logic, &gameplay_physics, tick_seconds, 1.f);
+
+		tick_seconds_samples[ticks_count++] = getSeconds() - tick_start_seconds;
+
+		if (snapshot_path != NULL && gameplay_logic.current_wave_number == waves_count) { // The tick its last tank spawned
+			if (!saveGameplaySnapshot(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, snapshot_path))
+				fprintf(stderr, "citadel-bench: can't save %s\n", snapshot_path);
+			snapshot_path = NULL;
+		}
+
+		if (gameplay_logic.tanks_count > peak_tanks_count)
+			peak_tanks_count = gameplay_logic.tanks_count;
+		if (gameplay_logic.outposts_count > peak_outposts_count)
+			peak_outposts_count = gameplay_logic.outposts_count;
+		if (gameplay_draw_data.outpost_shot_animations.count > peak_outpost_shot_animations_count)
+			peak_outpost_shot_animations_count = gameplay_draw_data.outpost_shot_animations.count;
+		if (gameplay_draw_data.tank_shot_animations.count > peak_tank_shot_animations_count)
+			peak_tank_shot_animations_count = gameplay_draw_data.tank_shot_animations.count;
+	}
+
+	double total_seconds = getSeconds() - start_seconds;
+	bool is_complete = gameplay_logic.current_wave_number >= waves_count && gameplay_logic.seconds_till_next_wave < 0.f;
+
+	qsort(tick_seconds_samples, ticks_count, sizeof (double), compareDoubles);
+
+	printf("waves:                  %u\n", waves_count);
+	printf("ticks:                  %u (%.1f simulated seconds)\n", ticks_count, ticks_count * tick_seconds);
+	printf("ticks/sec:              %.0f\n", ticks_count / total_seconds);
+	printf("p50 tick:               %.3f us\n", tick_seconds_samples[ticks_count / 2] * 1e6);
+	printf("p99 tick:               %.3f us\n", tick_seconds_samples[ticks_count * 99 / 100] * 1e6);
+	printf("peak tanks:             %u\n", peak_tanks_count);
+	printf("peak outposts:          %u\n", peak_outposts_count);
+	printf("peak outpost shots:     %u\n", peak_outpost_shot_animations_count);
+	printf("peak tank shots:        %u\n", peak_tank_shot_animations_count);
+	printf("dropped shots:          %llu\n", (unsigned long long) (gameplay_draw_data.outpost_shot_animations.dropped_count + gameplay_draw_data.tank_shot_animations.dropped_count));
+
+	free(tick_seconds_samples);
+	if (!is_complete) {
+		fprintf(stderr, "citadel-bench: stopped after %u ticks, in wave %u of %u\n", ticks_count, gameplay_logic.current_wave_number, waves_count);
+		return 1;
+	}
+	return 0;
+}
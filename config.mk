@@ -1,8 +1,11 @@
 CC := gcc
 
 TARGET_EXEC := citadel
+BENCH_EXEC := citadel-bench
+PACK_EXEC := citadel-pack
 
 LIBS := :libraylib.a GL m pthread dl rt X11
+BENCH_LIBS := m pthread
 
 CPPFLAGS :=
 CFLAGS := -g
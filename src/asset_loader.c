@@ -0,0 +1,99 @@
+#include "asset_loader.h"
+#include "audio_thread.h"
+#include "trace.h"
+
+#define TEXTURE_ATLAS_NAME "texture-atlas"
+#define TEXTURE_ATLAS_PATH "assets/texture-atlas.png"
+#define BACKGROUND_MUSIC_NAME "background-music"
+#define BACKGROUND_MUSIC_PATH "assets/background-music.mp3"
+
+static void *runAssetLoaderThread(void *argument)
+{
+	AssetLoader *loader = argument;
+
+	InitAudioDevice();
+
+	if (openAssetPack(&loader->pack, loader->pack_path))
+		prefetchAssetPack(&loader->pack);
+
+	// Falls back to the source files per asset; decoding a PNG touches no GL state
+	if (findAssetPackEntry(&loader->pack, TEXTURE_ATLAS_NAME, ASSET_PACK_IMAGE) == NULL)
+		loader->texture_atlas_image = LoadImage(TEXTURE_ATLAS_PATH);
+
+	loader->background_music = loadAssetPackWave(&loader->pack, BACKGROUND_MUSIC_NAME);
+	if (loader->background_music.data == NULL)
+		loader->background_music = LoadWave(BACKGROUND_MUSIC_PATH);
+	if (loader->background_music.data != NULL) // Converted here so the mixer never has to
+		WaveFormat(&loader->background_music, AUDIO_SAMPLE_RATE, AUDIO_SAMPLE_SIZE, AUDIO_CHANNELS_COUNT);
+
+	loader->done_seconds = getTraceSeconds();
+
+	pthread_mutex_lock(&loader->mutex);
+	loader->is_done = true;
+	pthread_mutex_unlock(&loader->mutex);
+	return NULL;
+}
+
+void startAssetLoader(AssetLoader *loader, char const *pack_path)
+{
+	*loader = (AssetLoader) {
+		.pack_path = pack_path,
+		.start_seconds = getTraceSeconds(),
+	};
+	pthread_mutex_init(&loader->mutex, NULL);
+
+	// Without a thread, load right here; slower to the first frame, but the same result
+	if (pthread_create(&loader->thread, NULL, runAssetLoaderThread, loader) != 0) {
+		runAssetLoaderThread(loader);
+		loader->is_joined = true;
+	}
+}
+
+bool pollAssetLoader(AssetLoader *loader)
+{
+	if (loader->is_joined)
+		return true;
+
+	pthread_mutex_lock(&loader->mutex);
+	bool is_done = loader->is_done;
+	pthread_mutex_unlock(&loader->mutex);
+
+	if (is_done) {
+		pthread_join(loader->thread, NULL); // Already finished, so this only reaps it
+		loader->is_joined = true;
+	}
+	return is_done;
+}
+
+Texture2D uploadLoadedTextureAtlas(AssetLoader *loader)
+{
+	Texture2D texture_atlas = loadAssetPackTexture(&loader->pack, TEXTURE_ATLAS_NAME);
+	if (texture_atlas.id == 0 && loader->texture_atlas_image.data != NULL) {
+		texture_atlas = LoadTextureFromImage(loader->texture_atlas_image);
+		UnloadImage(loader->texture_atlas_image);
+		loader->texture_atlas_image = (Image) {};
+	}
+	return texture_atlas;
+}
+
+Wave takeLoadedMusic(AssetLoader *loader)
+{
+	Wave background_music = loader->background_music;
+	loader->background_music = (Wave) {};
+	return background_music;
+}
+
+void stopAssetLoader(AssetLoader *loader)
+{
+	if (!loader->is_joined) {
+		pthread_join(loader->thread, NULL);
+		loader->is_joined = true;
+	}
+
+	if (loader->background_music.data != NULL)
+		UnloadWave(loader->background_music);
+	if (loader->texture_atlas_image.data != NULL)
+		UnloadImage(loader->texture_atlas_image);
+	closeAssetPack(&loader->pack);
+	pthread_mutex_destroy(&loader->mutex);
+}
@@ -0,0 +1,47 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include <raylib.h>
+
+#include "asset_pack.h"
+
+// Brings up the audio device and reads and decodes every asset on a thread
+// of its own, so the first frame doesn't wait on the disk. Only what has to
+// happen on the thread owning the GL context, uploading the atlas, is left
+// for the main thread once pollAssetLoader() says the loader is done.
+typedef struct {
+	char const *pack_path;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	bool is_done; // Guarded by mutex; until it's set, the rest belongs to the loader thread
+	bool is_joined;
+
+	AssetPack pack; // Read in ahead of use
+	Image texture_atlas_image; // Decoded from the PNG when the pack has no atlas
+	Wave background_music; // Decoded whole, already in the audio thread's format
+
+	double start_seconds; // getTraceSeconds() clock
+	double done_seconds;
+} AssetLoader;
+
+// Without a pack at pack_path, loads the source files instead
+void startAssetLoader(AssetLoader *loader, char const *pack_path);
+
+// Doesn't block; once true, the results are the main thread's to use
+bool pollAssetLoader(AssetLoader *loader);
+
+// Main thread, once polled done: the GPU upload, from the pack or the decoded PNG
+Texture2D uploadLoadedTextureAtlas(AssetLoader *loader);
+
+// Main thread, once polled done: hands over the music, which the loader no
+// longer unloads
+Wave takeLoadedMusic(AssetLoader *loader);
+
+// Waits for the loader if it's still running, then unloads the pack and
+// whatever wasn't taken
+void stopAssetLoader(AssetLoader *loader);
+
+#endif
@@ -0,0 +1,117 @@
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "asset_pack.h"
+
+// An image's pixels must fit in its entry, or uploading reads past it,
+// maybe past the end of the mapping
+static bool isAssetPackImageValid(AssetPackEntry const *entry)
+{
+	return (
+		entry->format >= PIXELFORMAT_UNCOMPRESSED_GRAYSCALE && entry->format <= PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA &&
+		entry->width > 0 && entry->width <= ASSET_PACK_MAXIMUM_IMAGE_SIZE &&
+		entry->height > 0 && entry->height <= ASSET_PACK_MAXIMUM_IMAGE_SIZE &&
+		(uint64_t) GetPixelDataSize(entry->width, entry->height, entry->format) <= entry->size
+	);
+}
+
+bool openAssetPack(AssetPack *pack, char const *path)
+{
+	*pack = (AssetPack) {};
+
+	int file = open(path, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat status;
+	void *image = MAP_FAILED;
+	if (fstat(file, &status) == 0 && (size_t) status.st_size >= sizeof (AssetPackHeader))
+		image = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file); // The mapping outlives the descriptor
+	if (image == MAP_FAILED)
+		return false;
+
+	AssetPackHeader const *header = image;
+	bool is_valid = (
+		header->magic == ASSET_PACK_MAGIC &&
+		header->version == ASSET_PACK_VERSION &&
+		header->file_size == (uint64_t) status.st_size &&
+		header->entries_count <= (status.st_size - sizeof (AssetPackHeader)) / sizeof (AssetPackEntry)
+	);
+
+	AssetPackEntry const *entries = (AssetPackEntry const *) (header + 1);
+	for (uint32_t i = 0; is_valid && i < header->entries_count; i++) {
+		is_valid = entries[i].offset <= (uint64_t) status.st_size && entries[i].size <= status.st_size - entries[i].offset;
+		if (is_valid && entries[i].type == ASSET_PACK_IMAGE)
+			is_valid = isAssetPackImageValid(&entries[i]);
+	}
+
+	if (!is_valid) {
+		munmap(image, status.st_size);
+		return false;
+	}
+
+	*pack = (AssetPack) {
+		.image = image,
+		.size = status.st_size,
+		.entries = entries,
+		.entries_count = header->entries_count,
+	};
+	return true;
+}
+
+void closeAssetPack(AssetPack *pack)
+{
+	if (pack->image != NULL)
+		munmap((void *) pack->image, pack->size);
+	*pack = (AssetPack) {};
+}
+
+void prefetchAssetPack(AssetPack const *pack)
+{
+	long page_size = sysconf(_SC_PAGESIZE);
+	if (page_size <= 0)
+		return;
+
+	uint8_t volatile sum = 0; // Keeps the reads from being optimized out
+	for (size_t i = 0; i < pack->size; i += page_size)
+		sum += pack->image[i];
+}
+
+AssetPackEntry const *findAssetPackEntry(AssetPack const *pack, char const *name, AssetPackEntryType type)
+{
+	for (uint32_t i = 0; i < pack->entries_count; i++)
+		if (pack->entries[i].type == type && strncmp(pack->entries[i].name, name, ASSET_PACK_NAME_SIZE) == 0)
+			return &pack->entries[i];
+	return NULL;
+}
+
+Texture2D loadAssetPackTexture(AssetPack const *pack, char const *name)
+{
+	AssetPackEntry const *entry = findAssetPackEntry(pack, name, ASSET_PACK_IMAGE);
+	if (entry == NULL || !isAssetPackImageValid(entry))
+		return (Texture2D) {};
+
+	// Uploaded straight from the mapping; raylib only reads image data
+	return LoadTextureFromImage((Image) {
+		.data = (void *) (pack->image + entry->offset),
+		.width = entry->width,
+		.height = entry->height,
+		.mipmaps = 1,
+		.format = entry->format,
+	});
+}
+
+Wave loadAssetPackWave(AssetPack const *pack, char const *name)
+{
+	AssetPackEntry const *entry = findAssetPackEntry(pack, name, ASSET_PACK_AUDIO);
+	if (entry == NULL)
+		return (Wave) {};
+
+	char file_type[ASSET_PACK_FILE_TYPE_SIZE + 1] = {};
+	memcpy(file_type, entry->file_type, ASSET_PACK_FILE_TYPE_SIZE);
+	return LoadWaveFromMemory(file_type, pack->image + entry->offset, entry->size);
+}
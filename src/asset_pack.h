@@ -0,0 +1,68 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <raylib.h>
+
+#define ASSET_PACK_MAGIC 0x4b504443 // "CDPK", little-endian
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_ALIGNMENT 64 // Of every entry's data
+#define ASSET_PACK_NAME_SIZE 48
+#define ASSET_PACK_FILE_TYPE_SIZE 8
+#define ASSET_PACK_MAXIMUM_IMAGE_SIZE 8192 // Per side; keeps GetPixelDataSize() within an int for any format
+
+#define ASSET_PACK_PATH "assets/citadel.pack" // Written by `make pack`
+
+typedef enum {
+	ASSET_PACK_IMAGE, // Raw pixels, ready to upload as they are
+	ASSET_PACK_AUDIO, // An audio file raylib streams from memory, re-encoded to decode cheaply
+} AssetPackEntryType;
+
+typedef struct {
+	char name[ASSET_PACK_NAME_SIZE]; // The source file's name without its extension
+	uint64_t offset; // From the start of the pack
+	uint64_t size;
+	uint32_t type;
+	uint32_t width; // Images only, as are height and format
+	uint32_t height;
+	uint32_t format; // A raylib PixelFormat
+	char file_type[ASSET_PACK_FILE_TYPE_SIZE]; // Audio only, e.g. ".qoa"
+} AssetPackEntry;
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t entries_count;
+	uint64_t file_size;
+} AssetPackHeader;
+
+// Everything decoded offline by tools/pack_assets.c into one file: a header,
+// the entry table, then each entry's data. Opening maps the file, so assets
+// are read straight out of the page cache and only the pages used are read.
+typedef struct {
+	uint8_t const *image; // The whole mapped file
+	size_t size;
+	AssetPackEntry const *entries;
+	uint32_t entries_count;
+} AssetPack;
+
+// False on I/O errors or a foreign or truncated file
+bool openAssetPack(AssetPack *pack, char const *path);
+void closeAssetPack(AssetPack *pack); // Unload what came from the pack first
+
+// Faults every page in on the calling thread, so later reads of the
+// mapping don't stall on the disk
+void prefetchAssetPack(AssetPack const *pack);
+
+AssetPackEntry const *findAssetPackEntry(AssetPack const *pack, char const *name, AssetPackEntryType type); // NULL if missing
+
+// Give raylib's empty texture or wave if the entry is missing or damaged.
+// The texture needs the window up; the wave is decoded whole into memory of
+// its own, so it outlives the pack.
+Texture2D loadAssetPackTexture(AssetPack const *pack, char const *name);
+Wave loadAssetPackWave(AssetPack const *pack, char const *name);
+
+#endif
@@ -0,0 +1,185 @@
+#include <string.h>
+#include <time.h>
+
+#include "audio_thread.h"
+
+// raylib's stream callbacks take no user pointer, so the one ring the
+// device drains is kept here
+static PcmRing *device_ring;
+
+// Runs on the audio device's own thread, so it must never block
+static void fillAudioDeviceBuffer(void *buffer, unsigned int frames_count)
+{
+	readPcmRing(device_ring, buffer, frames_count);
+}
+
+bool sendAudioCommand(AudioThread *audio, AudioCommand command)
+{
+	AudioCommandQueue *queue = &audio->commands;
+	uint32_t sent_count = atomic_load_explicit(&queue->sent_count, memory_order_relaxed); // Our own
+	uint32_t received_count = atomic_load_explicit(&queue->received_count, memory_order_acquire);
+	if (sent_count - received_count == AUDIO_COMMANDS_CAPACITY)
+		return false;
+
+	queue->commands[sent_count & (AUDIO_COMMANDS_CAPACITY - 1)] = command;
+	atomic_store_explicit(&queue->sent_count, sent_count + 1, memory_order_release);
+	return true;
+}
+
+static bool receiveAudioCommand(AudioCommandQueue *queue, AudioCommand *command)
+{
+	uint32_t received_count = atomic_load_explicit(&queue->received_count, memory_order_relaxed); // Our own
+	uint32_t sent_count = atomic_load_explicit(&queue->sent_count, memory_order_acquire);
+	if (received_count == sent_count)
+		return false;
+
+	*command = queue->commands[received_count & (AUDIO_COMMANDS_CAPACITY - 1)];
+	atomic_store_explicit(&queue->received_count, received_count + 1, memory_order_release);
+	return true;
+}
+
+static void mixAudioVoice(AudioVoice *voice, int32_t *mix, uint32_t frames_count)
+{
+	if (voice->wave == NULL || voice->is_paused)
+		return;
+
+	int16_t const *samples = voice->wave->data;
+	for (uint32_t i = 0; i < frames_count; i++) {
+		if (voice->next_frame == voice->wave->frameCount) {
+			if (!voice->is_looping) {
+				voice->wave = NULL; // Frees the voice
+				return;
+			}
+			voice->next_frame = 0;
+		}
+
+		for (uint8_t c = 0; c < AUDIO_CHANNELS_COUNT; c++)
+			mix[i * AUDIO_CHANNELS_COUNT + c] += samples[voice->next_frame * AUDIO_CHANNELS_COUNT + c];
+		voice->next_frame++;
+	}
+}
+
+static void applyAudioCommand(AudioThread *audio, AudioCommand command)
+{
+	switch (command.type) {
+	case AUDIO_COMMAND_PLAY_MUSIC:
+		audio->music_voice.is_paused = false;
+		break;
+	case AUDIO_COMMAND_PAUSE_MUSIC:
+		audio->music_voice.is_paused = true;
+		break;
+	case AUDIO_COMMAND_PLAY_SOUND:
+		if (command.sound == NULL || command.sound->frameCount == 0)
+			break;
+		for (uint8_t i = 0; i < AUDIO_SOUND_VOICES_COUNT; i++) {
+			if (audio->sound_voices[i].wave == NULL) {
+				audio->sound_voices[i] = (AudioVoice) {.wave = command.sound};
+				break;
+			}
+		}
+		break;
+	case AUDIO_COMMAND_QUIT:
+		break;
+	}
+}
+
+// Applies pending commands, then tops the ring up in whole chunks, silence
+// included, so the device never starves on purpose. False once told to quit.
+static bool runAudioMixer(AudioThread *audio)
+{
+	AudioCommand command;
+	while (receiveAudioCommand(&audio->commands, &command)) {
+		if (command.type == AUDIO_COMMAND_QUIT)
+			return false;
+		applyAudioCommand(audio, command);
+	}
+
+	int32_t mix[AUDIO_MIX_FRAMES_COUNT * AUDIO_CHANNELS_COUNT];
+	int16_t frames[AUDIO_MIX_FRAMES_COUNT * AUDIO_CHANNELS_COUNT];
+	while (audio->ring.capacity - getPcmRingFilledFrames(&audio->ring) >= AUDIO_MIX_FRAMES_COUNT) {
+		memset(mix, 0, sizeof mix);
+		mixAudioVoice(&audio->music_voice, mix, AUDIO_MIX_FRAMES_COUNT);
+		for (uint8_t i = 0; i < AUDIO_SOUND_VOICES_COUNT; i++)
+			mixAudioVoice(&audio->sound_voices[i], mix, AUDIO_MIX_FRAMES_COUNT);
+
+		for (uint32_t i = 0; i < AUDIO_MIX_FRAMES_COUNT * AUDIO_CHANNELS_COUNT; i++) // Clip rather than wrap
+			frames[i] = mix[i] > INT16_MAX ? INT16_MAX : mix[i] < INT16_MIN ? INT16_MIN : mix[i];
+
+		writePcmRing(&audio->ring, frames, AUDIO_MIX_FRAMES_COUNT);
+	}
+	return true;
+}
+
+static void *runAudioThread(void *argument)
+{
+	AudioThread *audio = argument;
+	while (runAudioMixer(audio))
+		nanosleep(&(struct timespec) {.tv_nsec = AUDIO_MIX_PERIOD_NANOSECONDS}, NULL);
+	return NULL;
+}
+
+bool startAudioThread(AudioThread *audio, Wave music)
+{
+	audio->music = music;
+	audio->music_voice = (AudioVoice) {
+		.wave = music.frameCount > 0 ? &audio->music : NULL,
+		.is_looping = true,
+		.is_paused = audio->music_voice.is_paused,
+	};
+
+	if (!initPcmRing(&audio->ring, AUDIO_RING_FRAMES_COUNT, AUDIO_CHANNELS_COUNT)) {
+		UnloadWave(audio->music);
+		audio->music = (Wave) {};
+		return false;
+	}
+
+	runAudioMixer(audio); // Full before the device first asks; the thread doesn't exist yet, so this is still single-threaded
+
+	if (pthread_create(&audio->thread, NULL, runAudioThread, audio) != 0) {
+		freePcmRing(&audio->ring);
+		UnloadWave(audio->music);
+		audio->music = (Wave) {};
+		return false;
+	}
+
+	device_ring = &audio->ring;
+	audio->stream = LoadAudioStream(AUDIO_SAMPLE_RATE, AUDIO_SAMPLE_SIZE, AUDIO_CHANNELS_COUNT);
+	SetAudioStreamCallback(audio->stream, fillAudioDeviceBuffer);
+	PlayAudioStream(audio->stream);
+
+	audio->is_running = true;
+	return true;
+}
+
+AudioStats getAudioStats(AudioThread const *audio)
+{
+	if (!audio->is_running)
+		return (AudioStats) {};
+
+	return (AudioStats) {
+		.filled_frames_count = getPcmRingFilledFrames(&audio->ring),
+		.capacity_frames_count = audio->ring.capacity,
+		.underruns_count = atomic_load_explicit(&audio->ring.underruns_count, memory_order_relaxed),
+		.underrun_frames_count = atomic_load_explicit(&audio->ring.underrun_frames_count, memory_order_relaxed),
+	};
+}
+
+void stopAudioThread(AudioThread *audio)
+{
+	if (!audio->is_running)
+		return;
+
+	// Once unloaded, the device stops calling back, so the ring can go
+	StopAudioStream(audio->stream);
+	UnloadAudioStream(audio->stream);
+	device_ring = NULL;
+
+	while (!sendAudioCommand(audio, (AudioCommand) {.type = AUDIO_COMMAND_QUIT})) // A full queue drains within a period
+		nanosleep(&(struct timespec) {.tv_nsec = AUDIO_MIX_PERIOD_NANOSECONDS}, NULL);
+	pthread_join(audio->thread, NULL);
+
+	freePcmRing(&audio->ring);
+	UnloadWave(audio->music);
+	audio->music = (Wave) {};
+	audio->is_running = false;
+}
@@ -0,0 +1,91 @@
+#ifndef AUDIO_THREAD_H
+#define AUDIO_THREAD_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <raylib.h>
+
+#include "pcm_ring.h"
+
+// The one format everything is mixed in; waves handed to the thread must
+// already be in it, e.g. through WaveFormat()
+#define AUDIO_SAMPLE_RATE 44100
+#define AUDIO_SAMPLE_SIZE 16
+#define AUDIO_CHANNELS_COUNT 2
+
+#define AUDIO_RING_FRAMES_COUNT 4096 // About 93 ms; covers the mixer being scheduled late, not the game
+#define AUDIO_MIX_FRAMES_COUNT 512 // Mixed and written in chunks of this many frames
+#define AUDIO_MIX_PERIOD_NANOSECONDS 5000000 // How long the mixer sleeps between top-ups
+#define AUDIO_SOUND_VOICES_COUNT 8
+#define AUDIO_COMMANDS_CAPACITY 64 // Power of two
+
+typedef enum {
+	AUDIO_COMMAND_PLAY_MUSIC,
+	AUDIO_COMMAND_PAUSE_MUSIC,
+	AUDIO_COMMAND_PLAY_SOUND, // One-shot; dropped if every voice is busy
+	AUDIO_COMMAND_QUIT,
+} AudioCommandType;
+
+typedef struct {
+	AudioCommandType type;
+	Wave const *sound; // AUDIO_COMMAND_PLAY_SOUND only; must stay loaded until the thread stops
+} AudioCommand;
+
+// Lock-free single-producer, single-consumer, like PcmRing: the main thread
+// sends, the mixer receives
+typedef struct {
+	AudioCommand commands[AUDIO_COMMANDS_CAPACITY];
+	_Alignas(PCM_RING_ALIGNMENT) _Atomic uint32_t sent_count;
+	_Alignas(PCM_RING_ALIGNMENT) _Atomic uint32_t received_count;
+} AudioCommandQueue;
+
+typedef struct {
+	Wave const *wave; // NULL while free
+	uint32_t next_frame;
+	bool is_looping;
+	bool is_paused;
+} AudioVoice;
+
+typedef struct {
+	uint32_t filled_frames_count;
+	uint32_t capacity_frames_count;
+	uint32_t underruns_count;
+	uint64_t underrun_frames_count;
+} AudioStats;
+
+// Mixes on a thread of its own into a PcmRing, which the audio device's
+// callback drains, so however long a frame takes, the device is fed from
+// audio mixed ahead of it. The main thread only ever sends commands and
+// reads stats, neither of which waits on the mixer.
+//
+// Zero-initialise it: commands sent before startAudioThread() are queued
+// and applied once it starts.
+typedef struct {
+	AudioCommandQueue commands;
+	PcmRing ring;
+	pthread_t thread;
+	AudioStream stream;
+	bool is_running;
+
+	// The mixer thread's own
+	Wave music;
+	AudioVoice music_voice;
+	AudioVoice sound_voices[AUDIO_SOUND_VOICES_COUNT];
+} AudioThread;
+
+// Needs the audio device up; takes ownership of music, which loops. False,
+// with music unloaded, if it can't start.
+bool startAudioThread(AudioThread *audio, Wave music);
+
+// Main thread only; false if the queue is full
+bool sendAudioCommand(AudioThread *audio, AudioCommand command);
+
+AudioStats getAudioStats(AudioThread const *audio);
+
+// Stops the device stream and the thread, and unloads the music
+void stopAudioThread(AudioThread *audio);
+
+#endif
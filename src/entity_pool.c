@@ -0,0 +1,188 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "entity_pool.h"
+
+void *allocateAligned(size_t size)
+{
+	// aligned_alloc() wants a multiple of the alignment
+	size_t rounded_size = (size + ENTITY_POOL_ALIGNMENT - 1) / ENTITY_POOL_ALIGNMENT * ENTITY_POOL_ALIGNMENT;
+	return aligned_alloc(ENTITY_POOL_ALIGNMENT, rounded_size > 0 ? rounded_size : ENTITY_POOL_ALIGNMENT);
+}
+
+// realloc() can't promise alignment, so copy by hand
+static void replaceAligned(void **array, void *new_array, size_t old_size)
+{
+	if (*array != NULL)
+		memcpy(new_array, *array, old_size);
+	free(*array);
+	*array = new_array;
+}
+
+void initEntityPool(EntityPool *pool, uint32_t capacity, uint8_t partitions_count)
+{
+	*pool = (EntityPool) {
+		.partitions_count = partitions_count > 0 ? partitions_count : 1, // Every entity is in some partition
+	};
+	reserveEntityPool(pool, capacity);
+}
+
+void registerEntityPoolArray(EntityPool *pool, void **array, size_t element_size)
+{
+	*array = allocateAligned(pool->capacity * element_size);
+
+	pool->arrays[pool->arrays_count] = array;
+	pool->arrays_element_sizes[pool->arrays_count] = element_size;
+	pool->arrays_count++;
+}
+
+bool reserveEntityPool(EntityPool *pool, uint32_t capacity)
+{
+	if (capacity <= pool->capacity)
+		return true;
+
+	// Everything is allocated before anything is replaced, so a failure
+	// leaves the pool as it was
+	uint32_t *dense_slots = allocateAligned(capacity * sizeof (uint32_t));
+	uint32_t *slot_dense_indices = allocateAligned(capacity * sizeof (uint32_t));
+	uint32_t *slot_generations = allocateAligned(capacity * sizeof (uint32_t));
+	void *arrays[ENTITY_POOL_MAXIMUM_ARRAYS_COUNT] = {};
+	bool is_allocated = dense_slots != NULL && slot_dense_indices != NULL && slot_generations != NULL;
+	for (uint8_t i = 0; i < pool->arrays_count && is_allocated; i++) {
+		arrays[i] = allocateAligned(capacity * pool->arrays_element_sizes[i]);
+		is_allocated = arrays[i] != NULL;
+	}
+
+	if (!is_allocated) {
+		free(dense_slots);
+		free(slot_dense_indices);
+		free(slot_generations);
+		for (uint8_t i = 0; i < pool->arrays_count; i++)
+			free(arrays[i]);
+		return false;
+	}
+
+	// Only live entities need copying; slot bookkeeping is needed in full
+	replaceAligned((void **) &pool->dense_slots, dense_slots, pool->capacity * sizeof (uint32_t));
+	replaceAligned((void **) &pool->slot_dense_indices, slot_dense_indices, pool->capacity * sizeof (uint32_t));
+	replaceAligned((void **) &pool->slot_generations, slot_generations, pool->capacity * sizeof (uint32_t));
+	for (uint8_t i = 0; i < pool->arrays_count; i++)
+		replaceAligned(pool->arrays[i], arrays[i], pool->count * pool->arrays_element_sizes[i]);
+
+	for (uint32_t i = pool->capacity; i < capacity; i++) {
+		pool->dense_slots[i] = i;
+		pool->slot_dense_indices[i] = 0;
+		pool->slot_generations[i] = 0;
+	}
+
+	pool->capacity = capacity;
+	return true;
+}
+
+static void moveEntity(EntityPool *pool, uint32_t from_index, uint32_t to_index)
+{
+	for (uint8_t i = 0; i < pool->arrays_count; i++) {
+		uint8_t *bytes = *pool->arrays[i];
+		memcpy(bytes + to_index * pool->arrays_element_sizes[i], bytes + from_index * pool->arrays_element_sizes[i], pool->arrays_element_sizes[i]);
+	}
+
+	pool->dense_slots[to_index] = pool->dense_slots[from_index];
+	pool->slot_dense_indices[pool->dense_slots[to_index]] = to_index;
+}
+
+bool createEntity(EntityPool *pool, uint8_t partition, uint32_t *index, EntityHandle *handle)
+{
+	if (pool->count == pool->capacity && !reserveEntityPool(pool, pool->capacity > 0 ? pool->capacity * 2 : 16))
+		return false;
+
+	uint32_t slot = pool->dense_slots[pool->count];
+
+	// Open a hole at the end, then walk it down to the end of the target
+	// partition by moving each later partition's first entity to its back
+	uint32_t hole_index = pool->count;
+	for (uint8_t i = pool->partitions_count - 1; i > partition; i--) {
+		uint32_t first_index = pool->partitions_first_index[i];
+		if (first_index != hole_index)
+			moveEntity(pool, first_index, hole_index);
+
+		hole_index = first_index;
+		pool->partitions_first_index[i]++;
+	}
+
+	pool->count++;
+	pool->partitions_first_index[pool->partitions_count] = pool->count;
+
+	pool->dense_slots[hole_index] = slot;
+	pool->slot_dense_indices[slot] = hole_index;
+
+	if (index != NULL)
+		*index = hole_index;
+	if (handle != NULL)
+		*handle = (EntityHandle) {
+			.slot = slot,
+			.generation = pool->slot_generations[slot],
+		};
+
+	return true;
+}
+
+void destroyEntity(EntityPool *pool, uint32_t index)
+{
+	uint32_t slot = pool->dense_slots[index];
+
+	uint8_t partition = 0;
+	while (index >= pool->partitions_first_index[partition + 1])
+		partition++;
+
+	// Fill the hole from the back of its own partition, then pass the new
+	// hole on through every later partition until it falls off the end
+	uint32_t hole_index = index;
+	for (uint8_t i = partition; i < pool->partitions_count; i++) {
+		uint32_t last_index = pool->partitions_first_index[i + 1] - 1;
+		if (last_index != hole_index)
+			moveEntity(pool, last_index, hole_index);
+
+		hole_index = last_index;
+		pool->partitions_first_index[i + 1]--;
+	}
+
+	pool->count--;
+
+	// Freed slot goes just past the live range, ready for reuse
+	pool->dense_slots[pool->count] = slot;
+	pool->slot_generations[slot]++;
+}
+
+EntityHandle getEntityHandle(EntityPool const *pool, uint32_t index)
+{
+	uint32_t slot = pool->dense_slots[index];
+	return (EntityHandle) {
+		.slot = slot,
+		.generation = pool->slot_generations[slot],
+	};
+}
+
+bool getEntityIndex(EntityPool const *pool, EntityHandle handle, uint32_t *index)
+{
+	if (handle.slot >= pool->capacity || pool->slot_generations[handle.slot] != handle.generation)
+		return false;
+
+	// Catches handles to slots that were never handed out
+	uint32_t dense_index = pool->slot_dense_indices[handle.slot];
+	if (dense_index >= pool->count || pool->dense_slots[dense_index] != handle.slot)
+		return false;
+
+	*index = dense_index;
+	return true;
+}
+
+void restoreEntityPool(EntityPool *pool, uint32_t count, uint32_t slots_count)
+{
+	for (uint32_t i = slots_count; i < pool->capacity; i++) {
+		pool->dense_slots[i] = i;
+		pool->slot_dense_indices[i] = 0;
+		pool->slot_generations[i] = 0;
+	}
+
+	pool->count = count;
+}
@@ -0,0 +1,71 @@
+#ifndef ENTITY_POOL_H
+#define ENTITY_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ENTITY_POOL_MAXIMUM_ARRAYS_COUNT 16
+#define ENTITY_POOL_MAXIMUM_PARTITIONS_COUNT 8
+#define ENTITY_POOL_ALIGNMENT 64 // Cache line; also enough for any SIMD load
+
+// Identifies an entity across swap-removes; goes stale once the entity is
+// destroyed, even if its slot is reused
+typedef struct {
+	uint32_t slot;
+	uint32_t generation;
+} EntityHandle;
+
+// Owns a set of per-entity arrays (one per component, struct-of-arrays style)
+// and keeps them densely packed and in lockstep. Destroying swaps the last
+// entity into the hole, so indices are unstable; hold an EntityHandle to
+// refer to an entity across ticks. Capacity doubles when exhausted, but
+// callers that can't afford to allocate mid-tick should reserve up front.
+//
+// Entities can also be kept grouped into contiguous partitions (e.g. one
+// per type) so loops can run one specialised kernel per range. Creating or
+// destroying then costs one move per later partition.
+typedef struct {
+	uint32_t *dense_slots; // [count, capacity) doubles as the free slot list
+	uint32_t *slot_dense_indices;
+	uint32_t *slot_generations;
+
+	void **arrays[ENTITY_POOL_MAXIMUM_ARRAYS_COUNT];
+	size_t arrays_element_sizes[ENTITY_POOL_MAXIMUM_ARRAYS_COUNT];
+	uint8_t arrays_count;
+
+	// Partition p spans [partitions_first_index[p], partitions_first_index[p + 1]);
+	// partitions_first_index[partitions_count] is always count
+	uint32_t partitions_first_index[ENTITY_POOL_MAXIMUM_PARTITIONS_COUNT + 1];
+	uint8_t partitions_count;
+
+	uint32_t count;
+	uint32_t capacity;
+} EntityPool;
+
+void *allocateAligned(size_t size); // ENTITY_POOL_ALIGNMENT-aligned, release with free()
+
+// A partitions_count of 0 is taken as 1, i.e. unpartitioned
+void initEntityPool(EntityPool *pool, uint32_t capacity, uint8_t partitions_count);
+
+// Allocates *array at the pool's capacity and keeps it sized from then on
+void registerEntityPoolArray(EntityPool *pool, void **array, size_t element_size);
+
+// Returns false only if growing fails, leaving the pool as it was
+bool reserveEntityPool(EntityPool *pool, uint32_t capacity);
+
+// Either out-parameter may be NULL; returns false if growing fails
+bool createEntity(EntityPool *pool, uint8_t partition, uint32_t *index, EntityHandle *handle);
+// Moved entities only ever land at or after index, so a back-to-front sweep
+// can destroy as it goes
+void destroyEntity(EntityPool *pool, uint32_t index);
+
+EntityHandle getEntityHandle(EntityPool const *pool, uint32_t index);
+bool getEntityIndex(EntityPool const *pool, EntityHandle handle, uint32_t *index);
+
+// For restoring a saved pool: takes count entities and frees every slot from
+// slots_count on, leaving the caller to copy in the first slots_count slots'
+// bookkeeping, the partitions and the live entities. Reserve slots_count first.
+void restoreEntityPool(EntityPool *pool, uint32_t count, uint32_t slots_count);
+
+#endif
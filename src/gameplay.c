@@ -0,0 +1,716 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <raymath.h>
+
+#include "gameplay.h"
+#include "trace.h"
+
+#define SQRT_2_F 1.414213f
+
+Vector2 game_state_tanks_path_points[] = {
+	(Vector2) {0, 200},
+	(Vector2) {1000, 200},
+	(Vector2) {1000, 550},
+	(Vector2) {100, 550},
+	(Vector2) {100, 900},
+	(Vector2) {1300, 900},
+	(Vector2) {1300, 100},
+	(Vector2) {1650, 100},
+	(Vector2) {1650, 1000},
+	(Vector2) {1920, 1000},
+};
+uint8_t const game_state_tanks_path_points_count = sizeof game_state_tanks_path_points / sizeof (Vector2);
+
+Rectangle const tanks_atlas_source_rectangles[TANK_TYPES_COUNT] = {
+	[TANK_SINGLE] = GREEN_TANK_ATLAS_SOURCE_RECTANGLE,
+	[TANK_DOUBLE] = BLUE_TANK_ATLAS_SOURCE_RECTANGLE,
+	[TANK_PIERCE] = RED_TANK_ATLAS_SOURCE_RECTANGLE,
+};
+
+// Tanks double every wave, in an even mix of types, 200 to 400 px apart
+static WaveSpecification const waves_specifications[] = {
+	{.tanks_count = 1, .tank_types_weights = {[TANK_SINGLE] = 1, [TANK_DOUBLE] = 1, [TANK_PIERCE] = 1}, .spacing = 200.f, .spacing_jitter = 1.f, .pause_seconds = 0.f},
+	{.tanks_count = 2, .tank_types_weights = {[TANK_SINGLE] = 1, [TANK_DOUBLE] = 1, [TANK_PIERCE] = 1}, .spacing = 200.f, .spacing_jitter = 1.f, .pause_seconds = 15.f},
+	{.tanks_count = 4, .tank_types_weights = {[TANK_SINGLE] = 1, [TANK_DOUBLE] = 1, [TANK_PIERCE] = 1}, .spacing = 200.f, .spacing_jitter = 1.f, .pause_seconds = 15.f},
+	{.tanks_count = 8, .tank_types_weights = {[TANK_SINGLE] = 1, [TANK_DOUBLE] = 1, [TANK_PIERCE] = 1}, .spacing = 200.f, .spacing_jitter = 1.f, .pause_seconds = 15.f},
+	{.tanks_count = 16, .tank_types_weights = {[TANK_SINGLE] = 1, [TANK_DOUBLE] = 1, [TANK_PIERCE] = 1}, .spacing = 200.f, .spacing_jitter = 1.f, .pause_seconds = 15.f},
+	{.tanks_count = 32, .tank_types_weights = {[TANK_SINGLE] = 1, [TANK_DOUBLE] = 1, [TANK_PIERCE] = 1}, .spacing = 200.f, .spacing_jitter = 1.f, .pause_seconds = 15.f},
+	{.tanks_count = 64, .tank_types_weights = {[TANK_SINGLE] = 1, [TANK_DOUBLE] = 1, [TANK_PIERCE] = 1}, .spacing = 200.f, .spacing_jitter = 1.f, .pause_seconds = 15.f},
+	{.tanks_count = 128, .tank_types_weights = {[TANK_SINGLE] = 1, [TANK_DOUBLE] = 1, [TANK_PIERCE] = 1}, .spacing = 200.f, .spacing_jitter = 1.f, .pause_seconds = 15.f},
+	{.tanks_count = 256, .tank_types_weights = {[TANK_SINGLE] = 1, [TANK_DOUBLE] = 1, [TANK_PIERCE] = 1}, .spacing = 200.f, .spacing_jitter = 1.f, .pause_seconds = 15.f},
+	{.tanks_count = 512, .tank_types_weights = {[TANK_SINGLE] = 1, [TANK_DOUBLE] = 1, [TANK_PIERCE] = 1}, .spacing = 200.f, .spacing_jitter = 1.f, .pause_seconds = 15.f},
+};
+#define WAVES_SPECIFICATIONS_COUNT (sizeof waves_specifications / sizeof (WaveSpecification))
+
+
+
+
+void initGameplay(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data, Vector2 *tanks_path_points, uint8_t tanks_path_points_count, Texture2D texture_atlas, uint64_t seed)
+{
+	*gameplay_logic = (GameplayLogic) {
+		.prng = seedPrng(seed),
+		.seconds_till_next_wave = waves_specifications[0].pause_seconds,
+	};
+	initWorkerPool(&gameplay_logic->worker_pool, GAMEPLAY_WORKERS_COUNT);
+	initPath(&gameplay_logic->tanks_path, tanks_path_points, tanks_path_points_count);
+
+	// Outpost centres must keep a base's half-diagonal clear of the path's edge
+	initPlacementMap(&gameplay_logic->placement_map, MAP_WIDTH, MAP_HEIGHT);
+	blockPlacementNearPath(&gameplay_logic->placement_map, tanks_path_points, tanks_path_points_count, TANKS_PATH_THICKNESS / 2 + OUTPOST_BASE_SIZE / SQRT_2_F);
+
+	*gameplay_physics = (GameplayPhysics) {
+		.integrate = selectIntegrateFunction(),
+		.range_filter = selectRangeFilterKernels(),
+		.tanks_path = &gameplay_logic->tanks_path,
+		.worker_pool = &gameplay_logic->worker_pool,
+	};
+	initSpatialGrid(&gameplay_physics->tanks_grid, MAP_WIDTH, MAP_HEIGHT, TANKS_GRID_CELL_SIZE, INITIAL_TANKS_CAPACITY);
+
+	*gameplay_draw_data = (GameplayDrawData) {
+		.texture_atlas = texture_atlas,
+		.tanks_path_points = tanks_path_points,
+		.tanks_path_points_count = tanks_path_points_count,
+	};
+
+	// The pools allocate every per-entity array and keep it sized
+
+	initEntityPool(&gameplay_logic->outposts_pool, INITIAL_OUTPOSTS_CAPACITY, OUTPOST_TYPES_COUNT);
+	registerEntityPoolArray(&gameplay_logic->outposts_pool, (void **) &gameplay_logic->outposts_logic, sizeof (OutpostLogic));
+	registerEntityPoolArray(&gameplay_logic->outposts_pool, (void **) &gameplay_physics->outposts_physics, sizeof (OutpostPhysics));
+	registerEntityPoolArray(&gameplay_logic->outposts_pool, (void **) &gameplay_draw_data->outposts_draw_data, sizeof (OutpostDrawData));
+
+	initEntityPool(&gameplay_logic->tanks_pool, INITIAL_TANKS_CAPACITY, TANK_TYPES_COUNT);
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_logic->tanks_logic, sizeof (TankLogic));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_physics->tanks_physics.progresses, sizeof (float));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_physics->tanks_physics.speeds, sizeof (float));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_physics->tanks_physics.accelerations, sizeof (float));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_physics->tanks_physics.positions_x, sizeof (float));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_physics->tanks_physics.positions_y, sizeof (float));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_physics->tanks_physics.velocities_x, sizeof (float));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_physics->tanks_physics.velocities_y, sizeof (float));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_physics->previous_tanks_physics.positions_x, sizeof (float));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_physics->previous_tanks_physics.positions_y, sizeof (float));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_physics->previous_tanks_physics.velocities_x, sizeof (float));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_physics->previous_tanks_physics.velocities_y, sizeof (float));
+	registerEntityPoolArray(&gameplay_logic->tanks_pool, (void **) &gameplay_draw_data->tanks_draw_data, sizeof (TankDrawData));
+
+	// Each ring keeps a shot for as long as its longest animation runs
+	initParticleRing(
+		&gameplay_draw_data->outpost_shot_animations,
+		OUTPOST_SHOT_ANIMATIONS_CAPACITY,
+		sizeof (ShotAnimation),
+		fmaxf(OUTPOST_SIMPLE_ANIMATION_DURATION_SECONDS, fmaxf(OUTPOST_MORTAR_ANIMATION_DURATION_SECONDS, OUTPOST_PIERCE_ANIMATION_DURATION_SECONDS)),
+		SHOT_ANIMATIONS_OVERFLOW_POLICY
+	);
+	initParticleRing(&gameplay_draw_data->tank_shot_animations, TANK_SHOT_ANIMATIONS_CAPACITY, sizeof (ShotAnimation), TANK_SHOT_ANIMATION_DURATION_SECONDS, SHOT_ANIMATIONS_OVERFLOW_POLICY);
+}
+
+// Contents only last a tick, so growing starts them over
+static bool reserveShotEvents(ShotEvents *shots, uint32_t capacity)
+{
+	if (capacity <= shots->capacity)
+		return true;
+
+	free(shots->events);
+	*shots = (ShotEvents) {.events = malloc(capacity * sizeof (ShotEvent))};
+	if (shots->events == NULL)
+		return false;
+
+	shots->capacity = capacity;
+	return true;
+}
+
+// Called on the main thread only, so workers never allocate
+static bool reserveWorkersScratch(GameplayLogic *gameplay_logic, uint32_t tanks_count, uint32_t outposts_count)
+{
+	bool is_reserved = true;
+	for (uint32_t w = 0; w < gameplay_logic->worker_pool.workers_count; w++) {
+		GameplayWorkerScratch *scratch = &gameplay_logic->workers_scratch[w];
+		is_reserved &= reserveSpatialGridQuery(&scratch->tanks_query, tanks_count);
+		is_reserved &= reserveShotEvents(&scratch->outpost_shots, outposts_count);
+
+		if (tanks_count > scratch->tank_shots.capacity) {
+			// Zeroed, which no shot_stamp matches
+			free(scratch->tanks_shot_stamps);
+			scratch->tanks_shot_stamps = calloc(tanks_count, sizeof (uint32_t));
+			if (scratch->tanks_shot_stamps == NULL || !reserveShotEvents(&scratch->tank_shots, tanks_count)) {
+				free(scratch->tanks_shot_stamps);
+				free(scratch->tank_shots.events);
+				scratch->tanks_shot_stamps = NULL;
+				scratch->tank_shots = (ShotEvents) {};
+				is_reserved = false;
+			}
+		}
+	}
+	return is_reserved;
+}
+
+bool reserveGameplay(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, uint32_t tanks_count, uint32_t outposts_count)
+{
+	bool is_reserved = reserveEntityPool(&gameplay_logic->tanks_pool, tanks_count);
+	is_reserved &= reserveEntityPool(&gameplay_logic->outposts_pool, outposts_count);
+	is_reserved &= reserveSpatialGrid(&gameplay_physics->tanks_grid, tanks_count);
+	is_reserved &= reserveWorkersScratch(gameplay_logic, tanks_count, outposts_count);
+	return is_reserved;
+}
+
+
+
+
+static void syncOutpostsCounts(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data)
+{
+	gameplay_logic->outposts_count = gameplay_logic->outposts_pool.count;
+	gameplay_physics->outposts_count = gameplay_logic->outposts_pool.count;
+	gameplay_draw_data->outposts_count = gameplay_logic->outposts_pool.count;
+}
+
+static void syncTanksCounts(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data)
+{
+	gameplay_logic->tanks_count = gameplay_logic->tanks_pool.count;
+	gameplay_physics->tanks_count = gameplay_logic->tanks_pool.count;
+	gameplay_draw_data->tanks_count = gameplay_logic->tanks_pool.count;
+}
+
+// Leaves the indices of the tanks within radius of center in
+// query->indices, ascending within each grid row
+static uint32_t queryTanksInRange(GameplayPhysics const *gameplay_physics, SpatialGridQuery *query, Vector2 center, float radius)
+{
+	uint32_t candidates_count = querySpatialGrid(&gameplay_physics->tanks_grid, query, center, radius);
+	return gameplay_physics->range_filter.filterInRange(query->positions_x, query->positions_y, query->indices, candidates_count, center, radius, query->indices);
+}
+
+// Storage was reserved for the worst case before the tick
+static void recordShot(ShotEvents *shots, ShotEvent shot)
+{
+	shots->events[shots->count++] = shot;
+}
+
+// Enough workers that each gets at least minimum_items_per_worker items
+static uint32_t getWorkersCountFor(WorkerPool const *pool, uint32_t items_count, uint32_t minimum_items_per_worker)
+{
+	uint32_t workers_count = items_count / minimum_items_per_worker;
+	if (workers_count > pool->workers_count)
+		return pool->workers_count;
+	return workers_count > 0 ? workers_count : 1;
+}
+
+typedef struct {
+	GameplayLogic *gameplay_logic;
+	GameplayPhysics *gameplay_physics;
+	float frame_time;
+} GameplayTaskContext;
+
+// The ring's overflow policy may drop an animation; the shot itself still lands
+static void emitShotAnimation(ParticleRing *ring, double birth_seconds, ShotAnimation animation)
+{
+	ShotAnimation *slot = emitParticle(ring, birth_seconds);
+	if (slot != NULL)
+		*slot = animation;
+}
+
+typedef struct {
+	float shot_cooldown_seconds;
+	float shot_damage;
+	float animation_duration_seconds;
+	float turret_turn_rate;
+} OutpostTypeParameters;
+
+static OutpostTypeParameters const outposts_type_parameters[OUTPOST_TYPES_COUNT] = {
+	[OUTPOST_SIMPLE] = {
+		.shot_cooldown_seconds = OUTPOST_SIMPLE_SHOT_COOLDOWN_SECONDS,
+		.shot_damage = 10.f,
+		.animation_duration_seconds = OUTPOST_SIMPLE_ANIMATION_DURATION_SECONDS,
+		.turret_turn_rate = 0.025f,
+	},
+	[OUTPOST_MORTAR] = {
+		.shot_cooldown_seconds = OUTPOST_MORTAR_SHOT_COOLDOWN_SECONDS,
+		.shot_damage = 15.f,
+		.animation_duration_seconds = OUTPOST_MORTAR_ANIMATION_DURATION_SECONDS,
+		.turret_turn_rate = 0.025f,
+	},
+	[OUTPOST_PIERCE] = {
+		.shot_cooldown_seconds = OUTPOST_PIERCE_SHOT_COOLDOWN_SECONDS,
+		.shot_damage = 20.f,
+		.animation_duration_seconds = OUTPOST_PIERCE_ANIMATION_DURATION_SECONDS,
+		.turret_turn_rate = 0.1f,
+	},
+};
+
+// Called with a constant type, so it inlines into a branch-free kernel per
+// type. Covers the type's outposts within [first, last).
+static inline void updateOutpostsOfType(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayWorkerScratch *scratch, OutpostType type, uint32_t first, uint32_t last, float frame_time)
+{
+	OutpostTypeParameters const parameters = outposts_type_parameters[type];
+
+	uint32_t type_first = gameplay_logic->outposts_pool.partitions_first_index[type];
+	uint32_t type_last = gameplay_logic->outposts_pool.partitions_first_index[type + 1];
+
+	for (uint32_t i = type_first > first ? type_first : first; i < (type_last < last ? type_last : last); i++) {
+		// Lowest-indexed tank in range, same as a full scan would pick
+		uint32_t in_range_count = queryTanksInRange(gameplay_physics, &scratch->tanks_query, gameplay_physics->outposts_physics[i].position, OUTPOST_RANGE);
+		uint32_t j = gameplay_logic->tanks_count;
+		for (uint32_t k = 0; k < in_range_count; k++)
+			if (scratch->tanks_query.indices[k] < j)
+				j = scratch->tanks_query.indices[k];
+		if (j == gameplay_logic->tanks_count)
+			continue;
+
+		Vector2 difference = Vector2Subtract(getTankPosition(&gameplay_physics->tanks_physics, j), gameplay_physics->outposts_physics[i].position);
+		gameplay_physics->outposts_physics[i].turret_direction = Vector2Normalize(Vector2Add(
+			gameplay_physics->outposts_physics[i].turret_direction,
+			Vector2Scale(difference, parameters.turret_turn_rate * frame_time)
+		));
+
+		if (gameplay_logic->outposts_logic[i].seconds_since_last_shot < parameters.shot_cooldown_seconds)
+			continue;
+
+		recordShot(&scratch->outpost_shots, (ShotEvent) {i, j, parameters.shot_damage});
+		gameplay_logic->outposts_logic[i].seconds_since_last_shot = 0.f;
+	}
+}
+
+// One worker's share of outposts: turrets and outpost cooldowns are its own
+// to write, while anything shared with other workers is recorded as a shot
+static void runCombatTask(void *context, uint32_t worker_index, uint32_t workers_count)
+{
+	GameplayTaskContext const *task_context = context;
+	GameplayLogic *gameplay_logic = task_context->gameplay_logic;
+	GameplayPhysics *gameplay_physics = task_context->gameplay_physics;
+	GameplayWorkerScratch *scratch = &gameplay_logic->workers_scratch[worker_index];
+
+	scratch->outpost_shots.count = 0;
+	scratch->tank_shots.count = 0;
+
+	uint32_t first;
+	uint32_t last;
+	getWorkerRange(gameplay_logic->outposts_count, 1, worker_index, workers_count, &first, &last);
+
+	// One pass per type over its own range, so the type's constants are hoisted out of the loop
+	updateOutpostsOfType(gameplay_logic, gameplay_physics, scratch, OUTPOST_SIMPLE, first, last, task_context->frame_time);
+	updateOutpostsOfType(gameplay_logic, gameplay_physics, scratch, OUTPOST_MORTAR, first, last, task_context->frame_time);
+	updateOutpostsOfType(gameplay_logic, gameplay_physics, scratch, OUTPOST_PIERCE, first, last, task_context->frame_time);
+
+	// Every ready tank in range is a candidate; whether it actually fires here
+	// depends on lower-indexed outposts, so that's settled when applying. Only
+	// a tank's first candidate in this range could fire, so the rest are skipped.
+	if (++scratch->shot_stamp == 0) {
+		memset(scratch->tanks_shot_stamps, 0, scratch->tank_shots.capacity * sizeof (uint32_t));
+		scratch->shot_stamp = 1;
+	}
+	for (uint32_t j = first; j < last; j++) {
+		uint32_t in_range_count = queryTanksInRange(gameplay_physics, &scratch->tanks_query, gameplay_physics->outposts_physics[j].position, TANK_RANGE);
+		for (uint32_t k = 0; k < in_range_count; k++) {
+			uint32_t i = scratch->tanks_query.indices[k];
+			if (gameplay_logic->tanks_logic[i].seconds_since_last_shot < TANK_SHOT_COOLDOWN_SECONDS || scratch->tanks_shot_stamps[i] == scratch->shot_stamp)
+				continue;
+
+			scratch->tanks_shot_stamps[i] = scratch->shot_stamp;
+			recordShot(&scratch->tank_shots, (ShotEvent) {j, i, 15.f});
+		}
+	}
+}
+
+WaveSpecification getWaveSpecification(uint32_t wave_number)
+{
+	if (wave_number < WAVES_SPECIFICATIONS_COUNT)
+		return waves_specifications[wave_number];
+
+	WaveSpecification wave = waves_specifications[WAVES_SPECIFICATIONS_COUNT - 1];
+	for (uint32_t i = WAVES_SPECIFICATIONS_COUNT - 1; i < wave_number && wave.tanks_count < WAVE_MAXIMUM_TANKS_COUNT; i++)
+		wave.tanks_count *= 2;
+	return wave;
+}
+
+uint32_t getPendingSpawnsCount(GameplayLogic const *gameplay_logic)
+{
+	if (gameplay_logic->is_wave_spawning)
+		return gameplay_logic->spawn_queue.count - gameplay_logic->spawn_queue.next_index;
+	return getWaveSpecification(gameplay_logic->current_wave_number).tanks_count;
+}
+
+// Rolls every tank's type and spawn time up front, in time order, so the
+// ticks after only pop the front of the queue
+static void startWave(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics)
+{
+	WaveSpecification wave = getWaveSpecification(gameplay_logic->current_wave_number);
+	SpawnQueue *queue = &gameplay_logic->spawn_queue;
+
+	clearSpawnQueue(queue);
+	if (!reserveSpawnQueue(queue, wave.tanks_count))
+		wave.tanks_count = queue->capacity; // A smaller wave beats none
+	// Usually a no-op, the caller having reserved before the tick
+	reserveGameplay(gameplay_logic, gameplay_physics, gameplay_logic->tanks_count + wave.tanks_count, gameplay_logic->outposts_count);
+
+	uint32_t weights_sum = 0;
+	for (uint8_t type = 0; type < TANK_TYPES_COUNT; type++)
+		weights_sum += wave.tank_types_weights[type];
+
+	float seconds = 0.f;
+	for (uint32_t i = 0; i < wave.tanks_count; i++) {
+		uint8_t type = 0;
+		if (weights_sum > 0) {
+			uint32_t roll = nextPrngUint32(&gameplay_logic->prng) % weights_sum;
+			while (roll >= wave.tank_types_weights[type])
+				roll -= wave.tank_types_weights[type++];
+		}
+
+		pushSpawn(queue, (Spawn) {seconds, type});
+		seconds += wave.spacing * (1.f + wave.spacing_jitter * nextPrngFloat(&gameplay_logic->prng)) / TANK_SPEED;
+	}
+
+	gameplay_logic->current_wave_seconds = 0.f;
+	gameplay_logic->is_wave_spawning = true;
+}
+
+// Starts progress along the path, where a tank due partway through the
+// last tick would be by now
+static void spawnTank(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data, TankType type, float progress)
+{
+	uint32_t index;
+	if (!createEntity(&gameplay_logic->tanks_pool, type, &index, NULL))
+		return;
+
+	gameplay_logic->tanks_logic[index] = (TankLogic) {
+		.health = TANK_MAXIMUM_HEALTH,
+		.seconds_since_last_shot = TANK_SHOT_COOLDOWN_SECONDS,
+		.type = type,
+	};
+
+	TanksPhysics *tanks_physics = &gameplay_physics->tanks_physics;
+	tanks_physics->progresses[index] = progress;
+	tanks_physics->speeds[index] = TANK_SPEED;
+	tanks_physics->accelerations[index] = 0.f;
+	evaluatePath(
+		&gameplay_logic->tanks_path,
+		tanks_physics->progresses + index,
+		tanks_physics->speeds + index,
+		1,
+		tanks_physics->positions_x + index,
+		tanks_physics->positions_y + index,
+		tanks_physics->velocities_x + index,
+		tanks_physics->velocities_y + index
+	);
+
+	gameplay_draw_data->tanks_draw_data[index].atlas_source_rectangle = tanks_atlas_source_rectangles[type];
+	gameplay_draw_data->tanks_draw_data[index].destination_rectangle = (Rectangle) {
+		.width = gameplay_draw_data->tanks_draw_data[index].atlas_source_rectangle.width,
+		.height = gameplay_draw_data->tanks_draw_data[index].atlas_source_rectangle.height,
+	};
+}
+
+void updateGameplayLogic(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data, float frame_time)
+{
+	double spawn_start_seconds = beginTraceSpan();
+	if (!gameplay_logic->is_wave_spawning && gameplay_logic->seconds_till_next_wave < 0.f)
+		startWave(gameplay_logic, gameplay_physics);
+
+	if (gameplay_logic->is_wave_spawning) {
+		Spawn const *spawn;
+		while ((spawn = popDueSpawn(&gameplay_logic->spawn_queue, gameplay_logic->current_wave_seconds)) != NULL)
+			spawnTank(gameplay_logic, gameplay_physics, gameplay_draw_data, spawn->type, (gameplay_logic->current_wave_seconds - spawn->seconds) * TANK_SPEED);
+		syncTanksCounts(gameplay_logic, gameplay_physics, gameplay_draw_data);
+		gameplay_logic->current_wave_seconds += frame_time;
+
+		if (gameplay_logic->spawn_queue.next_index == gameplay_logic->spawn_queue.count) {
+			gameplay_logic->is_wave_spawning = false;
+			gameplay_logic->current_wave_number++;
+			gameplay_logic->seconds_till_next_wave = getWaveSpecification(gameplay_logic->current_wave_number).pause_seconds;
+		}
+	}
+	gameplay_logic->seconds_till_next_wave -= frame_time;
+	endTraceSpan("spawn", spawn_start_seconds);
+
+	// No-ops when the caller reserved; if the grid or scratch can't cover the
+	// live counts, this tick goes without combat rather than overrun them
+	uint32_t workers_count = 0;
+	if (
+		reserveSpatialGrid(&gameplay_physics->tanks_grid, gameplay_logic->tanks_count) &&
+		reserveWorkersScratch(gameplay_logic, gameplay_logic->tanks_count, gameplay_logic->outposts_count) &&
+		rebuildSpatialGrid(&gameplay_physics->tanks_grid, gameplay_physics->tanks_physics.positions_x, gameplay_physics->tanks_physics.positions_y, gameplay_logic->tanks_count)
+	) {
+		GameplayTaskContext task_context = {gameplay_logic, gameplay_physics, frame_time};
+		workers_count = getWorkersCountFor(&gameplay_logic->worker_pool, gameplay_logic->outposts_count, GAMEPLAY_MINIMUM_OUTPOSTS_PER_WORKER);
+		runWorkerPool(&gameplay_logic->worker_pool, runCombatTask, &task_context, workers_count);
+	}
+
+	// Reduce in worker order, i.e. outpost order, so every subtraction from
+	// health happens in the same sequence whatever the workers count
+
+	for (uint32_t w = 0; w < workers_count; w++) {
+		ShotEvents const *shots = &gameplay_logic->workers_scratch[w].outpost_shots;
+		for (uint32_t k = 0; k < shots->count; k++) {
+			uint32_t i = shots->events[k].outpost_index;
+			uint32_t j = shots->events[k].tank_index;
+
+			gameplay_logic->tanks_logic[j].health -= shots->events[k].damage;
+			emitShotAnimation(&gameplay_draw_data->outpost_shot_animations, gameplay_draw_data->seconds_elapsed, (ShotAnimation) {
+				.outpost_position = gameplay_physics->outposts_physics[i].position,
+				.tank_position = getTankPosition(&gameplay_physics->tanks_physics, j),
+				.initial_direction = gameplay_physics->outposts_physics[i].turret_direction,
+				.duration_seconds = outposts_type_parameters[gameplay_logic->outposts_logic[i].type].animation_duration_seconds,
+				.type = gameplay_logic->outposts_logic[i].type,
+				.outpost_handle = getEntityHandle(&gameplay_logic->outposts_pool, i),
+				.tank_handle = getEntityHandle(&gameplay_logic->tanks_pool, j),
+			});
+		}
+	}
+
+	// Letting each ready tank fire once, in outpost order, gives every tank
+	// its lowest-indexed outpost, as scanning per tank did
+	for (uint32_t w = 0; w < workers_count; w++) {
+		ShotEvents const *shots = &gameplay_logic->workers_scratch[w].tank_shots;
+		for (uint32_t k = 0; k < shots->count; k++) {
+			uint32_t j = shots->events[k].outpost_index;
+			uint32_t i = shots->events[k].tank_index;
+			if (gameplay_logic->tanks_logic[i].seconds_since_last_shot < TANK_SHOT_COOLDOWN_SECONDS)
+				continue;
+
+			gameplay_logic->outposts_logic[j].health -= shots->events[k].damage;
+			emitShotAnimation(&gameplay_draw_data->tank_shot_animations, gameplay_draw_data->seconds_elapsed, (ShotAnimation) {
+				.outpost_position = gameplay_physics->outposts_physics[j].position,
+				.tank_position = getTankPosition(&gameplay_physics->tanks_physics, i),
+				.initial_direction = Vector2Normalize(getTankVelocity(&gameplay_physics->tanks_physics, i)),
+				.duration_seconds = TANK_SHOT_ANIMATION_DURATION_SECONDS,
+				.type = gameplay_logic->tanks_logic[i].type,
+				.outpost_handle = getEntityHandle(&gameplay_logic->outposts_pool, j),
+				.tank_handle = getEntityHandle(&gameplay_logic->tanks_pool, i),
+			});
+			gameplay_logic->tanks_logic[i].seconds_since_last_shot = 0.f;
+		}
+	}
+
+
+	// evict zero health elements, back to front so each swapped-in entity has already been checked
+
+	double evict_start_seconds = beginTraceSpan();
+	for (uint32_t i = gameplay_logic->outposts_pool.count; i-- > 0;) {
+		if (gameplay_logic->outposts_logic[i].health < 0.f) {
+			removePlacementBlocker(&gameplay_logic->placement_map, gameplay_physics->outposts_physics[i].position, OUTPOST_BASE_SIZE);
+			destroyEntity(&gameplay_logic->outposts_pool, i);
+		}
+	}
+	syncOutpostsCounts(gameplay_logic, gameplay_physics, gameplay_draw_data);
+
+	for (uint32_t i = gameplay_logic->tanks_pool.count; i-- > 0;)
+		if (gameplay_logic->tanks_logic[i].health < 0.f)
+			destroyEntity(&gameplay_logic->tanks_pool, i);
+	syncTanksCounts(gameplay_logic, gameplay_physics, gameplay_draw_data);
+	endTraceSpan("evict", evict_start_seconds);
+
+
+	// Tanks brake over the last stretch of the path and hold TANK_SPEED
+	// before it; a select rather than a branch, so this vectorizes
+	float braking_progress = gameplay_logic->tanks_path.length - 60.f;
+	TanksPhysics *tanks_physics = &gameplay_physics->tanks_physics;
+	for (uint32_t i = 0; i < gameplay_logic->tanks_count; i++)
+		tanks_physics->accelerations[i] = tanks_physics->progresses[i] >= braking_progress ? -5.f * tanks_physics->speeds[i] : 0.f;
+
+	for (uint32_t i = 0; i < gameplay_logic->outposts_count; i++)
+		gameplay_logic->outposts_logic[i].seconds_since_last_shot += frame_time;
+	for (uint32_t i = 0; i < gameplay_logic->tanks_count; i++)
+		gameplay_logic->tanks_logic[i].seconds_since_last_shot += frame_time;
+
+	gameplay_logic->ticks_count++;
+}
+
+// Tanks are independent, so each worker just integrates its own range
+static void runIntegrationTask(void *context, uint32_t worker_index, uint32_t workers_count)
+{
+	GameplayTaskContext const *task_context = context;
+	GameplayPhysics *gameplay_physics = task_context->gameplay_physics;
+	TanksPhysics *tanks_physics = &gameplay_physics->tanks_physics;
+	TanksPhysics *previous_tanks_physics = &gameplay_physics->previous_tanks_physics;
+
+	// Whole cache lines per worker
+	uint32_t first;
+	uint32_t last;
+	getWorkerRange(gameplay_physics->tanks_count, ENTITY_POOL_ALIGNMENT / sizeof (float), worker_index, workers_count, &first, &last);
+	size_t arrays_size = (last - first) * sizeof (float);
+
+	memcpy(previous_tanks_physics->positions_x + first, tanks_physics->positions_x + first, arrays_size);
+	memcpy(previous_tanks_physics->positions_y + first, tanks_physics->positions_y + first, arrays_size);
+	memcpy(previous_tanks_physics->velocities_x + first, tanks_physics->velocities_x + first, arrays_size);
+	memcpy(previous_tanks_physics->velocities_y + first, tanks_physics->velocities_y + first, arrays_size);
+
+	// Motion is one-dimensional along the path, so this is a single pass
+	// over three flat arrays, then a lookup back into the plane
+	gameplay_physics->integrate(tanks_physics->progresses + first, tanks_physics->speeds + first, tanks_physics->accelerations + first, last - first, task_context->frame_time);
+	evaluatePath(
+		gameplay_physics->tanks_path,
+		tanks_physics->progresses + first,
+		tanks_physics->speeds + first,
+		last - first,
+		tanks_physics->positions_x + first,
+		tanks_physics->positions_y + first,
+		tanks_physics->velocities_x + first,
+		tanks_physics->velocities_y + first
+	);
+}
+
+void updateGameplayPhysics(GameplayPhysics *gameplay_physics, float frame_time)
+{
+	GameplayTaskContext task_context = {NULL, gameplay_physics, frame_time};
+	runWorkerPool(
+		gameplay_physics->worker_pool,
+		runIntegrationTask,
+		&task_context,
+		getWorkersCountFor(gameplay_physics->worker_pool, gameplay_physics->tanks_count, GAMEPLAY_MINIMUM_TANKS_PER_WORKER)
+	);
+}
+
+// interpolation_factor in [0, 1] blends the previous tick's tank state into the current one
+void updateGameplayDrawData(GameplayDrawData *gameplay_draw_data, GameplayLogic const *gameplay_logic, GameplayPhysics const *gameplay_physics, float frame_time, float interpolation_factor)
+{
+	if (gameplay_draw_data->tanks_seconds_since_last_tick > 0.05f) {
+		if (gameplay_draw_data->tanks_texture_x_offset == 0)
+			gameplay_draw_data->tanks_texture_x_offset = 100;
+		else
+			gameplay_draw_data->tanks_texture_x_offset = 0;
+
+		gameplay_draw_data->tanks_seconds_since_last_tick = 0.f;
+	}
+	gameplay_draw_data->tanks_seconds_since_last_tick += frame_time;
+
+	// Animations age by the clock alone; expiry only pops the front of each ring
+
+	gameplay_draw_data->seconds_elapsed += frame_time;
+	expireParticles(&gameplay_draw_data->outpost_shot_animations, gameplay_draw_data->seconds_elapsed);
+	expireParticles(&gameplay_draw_data->tank_shot_animations, gameplay_draw_data->seconds_elapsed);
+
+
+	for (uint32_t i = 0; i < gameplay_draw_data->outposts_count; i++)
+		gameplay_draw_data->outposts_draw_data[i].turret_angle = atan2f(gameplay_physics->outposts_physics[i].turret_direction.y, gameplay_physics->outposts_physics[i].turret_direction.x) * 180.f / M_PI;
+
+	for (uint32_t i = 0; i < gameplay_draw_data->tanks_count; i++) {
+		Vector2 position = Vector2Lerp(getTankPosition(&gameplay_physics->previous_tanks_physics, i), getTankPosition(&gameplay_physics->tanks_physics, i), interpolation_factor);
+		Vector2 velocity = Vector2Lerp(getTankVelocity(&gameplay_physics->previous_tanks_physics, i), getTankVelocity(&gameplay_physics->tanks_physics, i), interpolation_factor);
+
+		if (Vector2Length(velocity) > 1)
+			gameplay_draw_data->tanks_draw_data[i].atlas_source_rectangle.x = gameplay_draw_data->tanks_texture_x_offset;
+
+		gameplay_draw_data->tanks_draw_data[i].destination_rectangle.x = position.x;
+		gameplay_draw_data->tanks_draw_data[i].destination_rectangle.y = position.y;
+
+		gameplay_draw_data->tanks_draw_data[i].angle = atan2f(velocity.y, velocity.x) * 180.f / M_PI - 90.f;
+	}
+
+	// Shots follow their tank while it lives and freeze where it died
+	uint32_t tank_index;
+	for (uint32_t k = 0; k < gameplay_draw_data->outpost_shot_animations.count; k++) {
+		ShotAnimation *animation = getParticle(&gameplay_draw_data->outpost_shot_animations, k);
+		if (getEntityIndex(&gameplay_logic->tanks_pool, animation->tank_handle, &tank_index)) {
+			animation->tank_position.x = gameplay_draw_data->tanks_draw_data[tank_index].destination_rectangle.x;
+			animation->tank_position.y = gameplay_draw_data->tanks_draw_data[tank_index].destination_rectangle.y;
+		}
+	}
+	for (uint32_t k = 0; k < gameplay_draw_data->tank_shot_animations.count; k++) {
+		ShotAnimation *animation = getParticle(&gameplay_draw_data->tank_shot_animations, k);
+		if (getEntityIndex(&gameplay_logic->tanks_pool, animation->tank_handle, &tank_index)) {
+			animation->tank_position.x = gameplay_draw_data->tanks_draw_data[tank_index].destination_rectangle.x;
+			animation->tank_position.y = gameplay_draw_data->tanks_draw_data[tank_index].destination_rectangle.y;
+		}
+	}
+}
+
+
+
+
+bool canOutpostBePlaced(GameplayLogic const *gameplay_logic, Vector2 position)
+{
+	return isPlacementValid(&gameplay_logic->placement_map, position);
+}
+
+#define SQRT_3_F 1.732050f
+void placeOutpost(OutpostType type, Vector2 position, OutpostLogic *logic, OutpostPhysics *physics, OutpostDrawData *draw_data)
+{
+	*logic = (OutpostLogic) {
+		.health = 100,
+		.type = type,
+	};
+
+	*physics = (OutpostPhysics) {
+		.position = position,
+		.turret_direction = {SQRT_3_F / 2.f, -1.f / 2.f},
+	};
+
+	*draw_data = (OutpostDrawData) {
+		.base_destination_rectangle = {
+			.x = position.x,
+			.y = position.y,
+			.width = 75,
+			.height = 75,
+		},
+		.turret_atlas_source_rectangle = {
+			.x = 30 * type,
+			.y = 280,
+			.width = 30,
+			.height = 11,
+		},
+		.turret_destination_rectangle = {
+			.x = position.x,
+			.y = position.y,
+			.width = 75,
+			.height = 30,
+		},
+		.turret_angle = -30,
+	};
+}
+
+bool addOutpost(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data, OutpostType type, Vector2 position)
+{
+	uint32_t index;
+	if (!createEntity(&gameplay_logic->outposts_pool, type, &index, NULL))
+		return false;
+
+	placeOutpost(type, position, gameplay_logic->outposts_logic + index, gameplay_physics->outposts_physics + index, gameplay_draw_data->outposts_draw_data + index);
+
+	// Bases can't overlap, so no other centre may come within a base's width on both axes
+	addPlacementBlocker(&gameplay_logic->placement_map, position, OUTPOST_BASE_SIZE);
+	syncOutpostsCounts(gameplay_logic, gameplay_physics, gameplay_draw_data);
+	return true;
+}
+
+bool applyGameplayCommand(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data, GameplayCommand command)
+{
+	if (command.outpost_type >= OUTPOST_TYPES_COUNT || !canOutpostBePlaced(gameplay_logic, command.position))
+		return false;
+
+	return addOutpost(gameplay_logic, gameplay_physics, gameplay_draw_data, command.outpost_type, command.position);
+}
+
+
+
+
+static uint32_t hashBytes(uint32_t hash, void const *bytes, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ ((uint8_t const *) bytes)[i]) * 16777619u;
+	return hash;
+}
+
+uint32_t getGameplayChecksum(GameplayLogic const *gameplay_logic, GameplayPhysics const *gameplay_physics)
+{
+	uint32_t hash = 2166136261u;
+
+	hash = hashBytes(hash, &gameplay_logic->prng, sizeof gameplay_logic->prng);
+	hash = hashBytes(hash, &gameplay_logic->ticks_count, sizeof gameplay_logic->ticks_count);
+	hash = hashBytes(hash, &gameplay_logic->seconds_till_next_wave, sizeof gameplay_logic->seconds_till_next_wave);
+	hash = hashBytes(hash, &gameplay_logic->current_wave_seconds, sizeof gameplay_logic->current_wave_seconds);
+	hash = hashBytes(hash, &gameplay_logic->current_wave_number, sizeof gameplay_logic->current_wave_number);
+	hash = hashBytes(hash, &gameplay_logic->is_wave_spawning, sizeof gameplay_logic->is_wave_spawning);
+	hash = hashBytes(hash, &gameplay_logic->spawn_queue.count, sizeof gameplay_logic->spawn_queue.count);
+	hash = hashBytes(hash, &gameplay_logic->spawn_queue.next_index, sizeof gameplay_logic->spawn_queue.next_index);
+
+	// Counts first, so equal arrays of different lengths still differ
+	hash = hashBytes(hash, &gameplay_logic->outposts_count, sizeof gameplay_logic->outposts_count);
+	hash = hashBytes(hash, gameplay_logic->outposts_logic, gameplay_logic->outposts_count * sizeof (OutpostLogic));
+	hash = hashBytes(hash, gameplay_physics->outposts_physics, gameplay_logic->outposts_count * sizeof (OutpostPhysics));
+
+	hash = hashBytes(hash, &gameplay_logic->tanks_count, sizeof gameplay_logic->tanks_count);
+	hash = hashBytes(hash, gameplay_logic->tanks_logic, gameplay_logic->tanks_count * sizeof (TankLogic));
+	hash = hashBytes(hash, gameplay_physics->tanks_physics.progresses, gameplay_logic->tanks_count * sizeof (float));
+	hash = hashBytes(hash, gameplay_physics->tanks_physics.speeds, gameplay_logic->tanks_count * sizeof (float));
+
+	return hash;
+}
@@ -0,0 +1,317 @@
+#ifndef GAMEPLAY_H
+#define GAMEPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <raylib.h> // Types only; nothing here may need a window
+
+#include "entity_pool.h"
+#include "integration.h"
+#include "particle_ring.h"
+#include "path.h"
+#include "placement_map.h"
+#include "prng.h"
+#include "range_filter.h"
+#include "spatial_grid.h"
+#include "spawn_queue.h"
+#include "worker_pool.h"
+
+#define MAP_WIDTH 1920
+#define MAP_HEIGHT 1080
+
+// Starting capacities; storage doubles past these, or use reserveGameplay()
+#define INITIAL_OUTPOSTS_CAPACITY 128
+#define INITIAL_TANKS_CAPACITY 1024
+
+// Shot animations live in fixed rings instead; past these, overflow policy applies
+#define OUTPOST_SHOT_ANIMATIONS_CAPACITY 1024
+#define TANK_SHOT_ANIMATIONS_CAPACITY 1024
+#ifndef SHOT_ANIMATIONS_OVERFLOW_POLICY // Newest shots matter most on screen
+#define SHOT_ANIMATIONS_OVERFLOW_POLICY PARTICLE_RING_DROP_OLDEST
+#endif
+
+#ifndef SIMULATION_TICKS_PER_SECOND // 30, 60 or 120; independent of SetTargetFPS()
+#define SIMULATION_TICKS_PER_SECOND 60
+#endif
+#define SIMULATION_TICK_SECONDS (1.f / SIMULATION_TICKS_PER_SECOND)
+#define MAXIMUM_SIMULATION_TICKS_PER_FRAME 8 // Beyond this a hitch slows the game down instead of spiralling
+
+#ifndef GAMEPLAY_WORKERS_COUNT // 0 means one per online CPU; results don't depend on it
+#define GAMEPLAY_WORKERS_COUNT 0
+#endif
+// Below these a phase isn't worth waking another worker for
+#define GAMEPLAY_MINIMUM_OUTPOSTS_PER_WORKER 16
+#define GAMEPLAY_MINIMUM_TANKS_PER_WORKER 4096
+
+typedef enum { // Also the order of the tanks pool's per-type partitions
+	TANK_SINGLE,
+	TANK_DOUBLE,
+	TANK_PIERCE,
+	TANK_TYPES_COUNT,
+} TankType;
+
+typedef struct {
+	float health;
+	float seconds_since_last_shot;
+	TankType type;
+} TankLogic;
+
+// One row of the wave table, turned into a SpawnQueue when the wave starts
+typedef struct {
+	uint32_t tanks_count;
+	uint8_t tank_types_weights[TANK_TYPES_COUNT]; // Relative odds of each type
+	float spacing; // Along the path, between one tank and the next
+	float spacing_jitter; // Each gap is up to this fraction longer, at random
+	float pause_seconds; // After the previous wave's last spawn
+} WaveSpecification;
+
+// A tank's state is how far along the path it is and how fast it's going
+// there; positions and velocities are evaluated from those after every
+// integration. One flat array per quantity, so integration streams through
+// them with SIMD; use the getTank*() helpers for per-tank vectors.
+typedef struct {
+	float *progresses;
+	float *speeds;
+	float *accelerations; // Along the path
+	float *positions_x;
+	float *positions_y;
+	float *velocities_x;
+	float *velocities_y;
+} TanksPhysics;
+
+typedef struct {
+	Rectangle atlas_source_rectangle;
+	Rectangle destination_rectangle;
+	float angle;
+} TankDrawData; // rename to TankDrawing or TankDrawingData
+
+typedef enum { // Also the order of the outposts pool's per-type partitions
+	OUTPOST_SIMPLE,
+	OUTPOST_MORTAR,
+	OUTPOST_PIERCE,
+	OUTPOST_TYPES_COUNT,
+} OutpostType;
+
+typedef struct {
+	float health;
+	float seconds_since_last_shot;
+	OutpostType type;
+} OutpostLogic;
+
+typedef struct {
+	Vector2 position;
+	Vector2 turret_direction;
+} OutpostPhysics;
+
+typedef struct {
+	Rectangle base_destination_rectangle;
+	Rectangle turret_atlas_source_rectangle;
+	Rectangle turret_destination_rectangle;
+	float turret_angle;
+} OutpostDrawData;
+
+typedef struct {
+	Vector2 outpost_position;
+	Vector2 tank_position;
+	Vector2 initial_direction;
+	float duration_seconds; // Up to its ring's lifetime
+	uint8_t type;
+	EntityHandle outpost_handle;
+	EntityHandle tank_handle;
+} ShotAnimation;
+
+typedef struct {
+	uint32_t outpost_index;
+	uint32_t tank_index;
+	float damage;
+} ShotEvent;
+
+typedef struct {
+	ShotEvent *events;
+	uint32_t count;
+	uint32_t capacity;
+} ShotEvents;
+
+// What a worker produces in the parallel combat phase. Shots are only
+// recorded there, then applied worker by worker, which is outpost order,
+// so health changes exactly as in a single-threaded tick.
+typedef struct {
+	_Alignas(ENTITY_POOL_ALIGNMENT) SpatialGridQuery tanks_query; // Own cache lines, so workers never false-share
+	ShotEvents outpost_shots; // At most one per outpost
+	ShotEvents tank_shots; // At most one per tank, going by tanks_shot_stamps
+	uint32_t *tanks_shot_stamps; // shot_stamp as of a tank's candidate shot here, sized like tank_shots
+	uint32_t shot_stamp; // Bumped every combat phase; never 0, which marks no shot
+} GameplayWorkerScratch;
+
+// Everything a player can change, applied just before tick number tick runs,
+// so a seed plus the commands reproduce a whole session
+typedef struct {
+	uint32_t tick;
+	Vector2 position;
+	uint8_t outpost_type;
+} GameplayCommand;
+
+
+
+
+typedef struct {
+	OutpostLogic *outposts_logic;
+	TankLogic *tanks_logic;
+	Path tanks_path;
+
+	// Own the outpost and tank arrays of all three Gameplay* structs, each
+	// kept partitioned into one contiguous range per type
+	EntityPool outposts_pool;
+	EntityPool tanks_pool;
+
+	PlacementMap placement_map; // Where a new outpost may go
+
+	WorkerPool worker_pool;
+	GameplayWorkerScratch workers_scratch[WORKER_POOL_MAXIMUM_WORKERS_COUNT];
+
+	Prng prng; // The simulation's only source of randomness, seeded per session
+	uint32_t ticks_count;
+
+	SpawnQueue spawn_queue; // The current wave's, while is_wave_spawning
+	float seconds_till_next_wave;
+	float current_wave_seconds;
+	uint8_t current_wave_number;
+	bool is_wave_spawning;
+
+	uint32_t outposts_count;
+	uint32_t tanks_count;
+} GameplayLogic;
+
+typedef struct {
+	OutpostPhysics *outposts_physics;
+	TanksPhysics tanks_physics;
+	TanksPhysics previous_tanks_physics; // Positions and velocities at the start of the last tick, for interpolated drawing
+	Path const *tanks_path; // Owned by GameplayLogic
+	SpatialGrid tanks_grid; // Rebuilt every tick
+	IntegrateFunction integrate; // Widest kernels the CPU supports
+	RangeFilterKernels range_filter;
+	WorkerPool *worker_pool; // Owned by GameplayLogic
+	uint32_t outposts_count;
+	uint32_t tanks_count;
+} GameplayPhysics;
+
+typedef struct {
+	Texture2D texture_atlas;
+	RenderTexture2D background; // Atlas background plus path, baked by the renderer; zero until then
+	Texture2D placement_overlay; // GameplayLogic's placement_map as a tint, also kept by the renderer
+	uint32_t placement_overlay_revision;
+	OutpostDrawData *outposts_draw_data;
+	TankDrawData *tanks_draw_data;
+	ParticleRing outpost_shot_animations; // Of ShotAnimation, aged by seconds_elapsed
+	ParticleRing tank_shot_animations;
+	double seconds_elapsed;
+	Vector2 *tanks_path_points;
+	float tanks_seconds_since_last_tick;
+	uint16_t tanks_texture_x_offset;
+	uint32_t outposts_count;
+	uint32_t tanks_count;
+	uint8_t tanks_path_points_count;
+} GameplayDrawData;
+
+
+
+
+static inline Vector2 getTankPosition(TanksPhysics const *tanks_physics, uint32_t index)
+{
+	return (Vector2) {tanks_physics->positions_x[index], tanks_physics->positions_y[index]};
+}
+
+static inline Vector2 getTankVelocity(TanksPhysics const *tanks_physics, uint32_t index)
+{
+	return (Vector2) {tanks_physics->velocities_x[index], tanks_physics->velocities_y[index]};
+}
+
+
+
+
+#define GREEN_TANK_ATLAS_SOURCE_RECTANGLE\
+	((Rectangle) {\
+	 	.x = 0,\
+		.y = 0,\
+		.width = 63,\
+		.height = 83,\
+	 })
+
+#define BLUE_TANK_ATLAS_SOURCE_RECTANGLE\
+	((Rectangle) {\
+	 	.x = 0,\
+		.y = 100,\
+		.width = 62,\
+		.height = 67,\
+	 })
+
+#define RED_TANK_ATLAS_SOURCE_RECTANGLE\
+	((Rectangle) {\
+	 	.x = 0,\
+		.y = 182,\
+		.width = 59,\
+		.height = 68,\
+	 })
+
+#define TANK_SPEED 150.f
+
+#define WAVE_MAXIMUM_TANKS_COUNT (1 << 20) // Where waves past the table stop doubling
+
+#define OUTPOST_RANGE 300.f
+#define TANK_RANGE 200.f
+#define TANKS_GRID_CELL_SIZE (OUTPOST_RANGE > TANK_RANGE ? OUTPOST_RANGE : TANK_RANGE) // Any range query spans at most 3x3 cells
+
+#define OUTPOST_SIMPLE_SHOT_COOLDOWN_SECONDS 0.5f
+#define OUTPOST_MORTAR_SHOT_COOLDOWN_SECONDS 1.5f
+#define OUTPOST_PIERCE_SHOT_COOLDOWN_SECONDS 1.5f
+#define TANK_SHOT_COOLDOWN_SECONDS 0.75f
+
+#define OUTPOST_MAXIMUM_HEALTH 100.f
+#define TANK_MAXIMUM_HEALTH 100.f
+
+#define OUTPOST_SIMPLE_ANIMATION_DURATION_SECONDS 0.25f
+#define OUTPOST_MORTAR_ANIMATION_DURATION_SECONDS 0.75f
+#define OUTPOST_PIERCE_ANIMATION_DURATION_SECONDS 0.75f
+#define TANK_SHOT_ANIMATION_DURATION_SECONDS 0.2f
+
+#define TANKS_PATH_THICKNESS 75
+
+#define OUTPOST_BASE_SIZE 75.f
+
+extern Rectangle const tanks_atlas_source_rectangles[TANK_TYPES_COUNT];
+
+extern Vector2 game_state_tanks_path_points[];
+extern uint8_t const game_state_tanks_path_points_count;
+
+
+
+
+void initGameplay(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data, Vector2 *tanks_path_points, uint8_t tanks_path_points_count, Texture2D texture_atlas, uint64_t seed);
+
+// Preallocates for the given peak counts so no tick has to grow storage,
+// workers' scratch included; false if some of it couldn't be
+bool reserveGameplay(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, uint32_t tanks_count, uint32_t outposts_count);
+
+// Rows past the end of the table keep doubling the last one's tanks
+WaveSpecification getWaveSpecification(uint32_t wave_number);
+
+// Tanks still to come from the current wave, or all of the next one's while
+// between waves: what reserveGameplay() needs on top of the live ones
+uint32_t getPendingSpawnsCount(GameplayLogic const *gameplay_logic);
+
+void updateGameplayLogic(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data, float frame_time);
+void updateGameplayPhysics(GameplayPhysics *gameplay_physics, float frame_time);
+void updateGameplayDrawData(GameplayDrawData *gameplay_draw_data, GameplayLogic const *gameplay_logic, GameplayPhysics const *gameplay_physics, float frame_time, float interpolation_factor);
+
+bool canOutpostBePlaced(GameplayLogic const *gameplay_logic, Vector2 position); // O(1) lookup in placement_map
+void placeOutpost(OutpostType type, Vector2 position, OutpostLogic *logic, OutpostPhysics *physics, OutpostDrawData *draw_data);
+bool addOutpost(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data, OutpostType type, Vector2 position); // False if the pool couldn't grow to fit it; doesn't check placement
+
+// Validates the command against the current state; false if it was rejected
+bool applyGameplayCommand(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data, GameplayCommand command);
+
+// FNV-1a over everything the simulation carries from one tick to the next
+uint32_t getGameplayChecksum(GameplayLogic const *gameplay_logic, GameplayPhysics const *gameplay_physics);
+
+#endif
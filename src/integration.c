@@ -0,0 +1,83 @@
+// A fused multiply-add rounds once instead of twice, so letting the compiler
+// contract (e.g. under -march=native) would break bit-identity between kernels
+#pragma GCC optimize ("fp-contract=off")
+
+#include "integration.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define INTEGRATION_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+void integrateScalar(float *positions, float *velocities, float const *accelerations, uint32_t count, float frame_time)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		velocities[i] += accelerations[i] * frame_time;
+		positions[i] += velocities[i] * frame_time;
+	}
+}
+
+
+
+
+#ifdef INTEGRATION_X86_KERNELS
+
+// Target attributes let these live in a baseline build; they only ever run
+// once __builtin_cpu_supports() has vouched for the instructions
+
+__attribute__((target("sse2")))
+static void integrateSse2(float *positions, float *velocities, float const *accelerations, uint32_t count, float frame_time)
+{
+	__m128 const frame_times = _mm_set1_ps(frame_time);
+
+	uint32_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 velocity = _mm_add_ps(_mm_loadu_ps(velocities + i), _mm_mul_ps(_mm_loadu_ps(accelerations + i), frame_times));
+		_mm_storeu_ps(velocities + i, velocity);
+		_mm_storeu_ps(positions + i, _mm_add_ps(_mm_loadu_ps(positions + i), _mm_mul_ps(velocity, frame_times)));
+	}
+
+	integrateScalar(positions + i, velocities + i, accelerations + i, count - i, frame_time);
+}
+
+__attribute__((target("avx2")))
+static void integrateAvx2(float *positions, float *velocities, float const *accelerations, uint32_t count, float frame_time)
+{
+	__m256 const frame_times = _mm256_set1_ps(frame_time);
+
+	uint32_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 velocity = _mm256_add_ps(_mm256_loadu_ps(velocities + i), _mm256_mul_ps(_mm256_loadu_ps(accelerations + i), frame_times));
+		_mm256_storeu_ps(velocities + i, velocity);
+		_mm256_storeu_ps(positions + i, _mm256_add_ps(_mm256_loadu_ps(positions + i), _mm256_mul_ps(velocity, frame_times)));
+	}
+
+	integrateScalar(positions + i, velocities + i, accelerations + i, count - i, frame_time);
+}
+
+#endif
+
+
+
+
+uint8_t getSupportedIntegrateKernels(IntegrateKernel kernels[INTEGRATE_KERNELS_MAXIMUM_COUNT])
+{
+	uint8_t kernels_count = 0;
+	kernels[kernels_count++] = (IntegrateKernel) {"scalar", integrateScalar};
+
+#ifdef INTEGRATION_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))
+		kernels[kernels_count++] = (IntegrateKernel) {"sse2", integrateSse2};
+	if (__builtin_cpu_supports("avx2"))
+		kernels[kernels_count++] = (IntegrateKernel) {"avx2", integrateAvx2};
+#endif
+
+	return kernels_count;
+}
+
+IntegrateFunction selectIntegrateFunction(void)
+{
+	IntegrateKernel kernels[INTEGRATE_KERNELS_MAXIMUM_COUNT];
+	return kernels[getSupportedIntegrateKernels(kernels) - 1].function;
+}
@@ -0,0 +1,26 @@
+#ifndef INTEGRATION_H
+#define INTEGRATION_H
+
+#include <stdint.h>
+
+// Explicit Euler along one axis: velocity += acceleration * dt, then
+// position += velocity * dt. Every kernel does exactly that multiply and add
+// per element (never fused), so all of them give bit-identical results.
+typedef void (*IntegrateFunction)(float *positions, float *velocities, float const *accelerations, uint32_t count, float frame_time);
+
+typedef struct {
+	char const *name;
+	IntegrateFunction function;
+} IntegrateKernel;
+
+#define INTEGRATE_KERNELS_MAXIMUM_COUNT 3
+
+void integrateScalar(float *positions, float *velocities, float const *accelerations, uint32_t count, float frame_time);
+
+// Fills kernels with those the running CPU supports, narrowest first
+uint8_t getSupportedIntegrateKernels(IntegrateKernel kernels[INTEGRATE_KERNELS_MAXIMUM_COUNT]);
+
+// Widest supported kernel
+IntegrateFunction selectIntegrateFunction(void);
+
+#endif
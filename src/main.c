@@ -1,63 +1,27 @@
 #include <stdint.h>
-#include <stdio.h> // Debugging
-#include <stdlib.h> // rand()
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
 #include <raylib.h>
 #include <raymath.h>
 
+#include "asset_loader.h"
+#include "audio_thread.h"
+#include "gameplay.h"
+#include "poisson_disk.h"
+#include "profiler.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "sprite_batch.h"
+#include "text_cache.h"
+#include "trail_mesh.h"
+
 #define WINDOW_WIDTH 1920
 #define WINDOW_HEIGHT 1080
 
-typedef enum { // separate each type into own array for data-orientation
-	TANK_SINGLE,
-	TANK_DOUBLE,
-	TANK_PIERCE,
-} TankType;
-
-typedef struct {
-	float health;
-	float seconds_since_last_shot;
-	TankType type;
-	uint8_t path_segment_index;
-} TankLogic;
-
-typedef struct {
-	Vector2 position;
-	Vector2 velocity;
-	Vector2 acceleration;
-} TankPhysics;
-
-typedef struct {
-	Rectangle atlas_source_rectangle;
-	Rectangle destination_rectangle;
-	float angle;
-} TankDrawData; // rename to TankDrawing or TankDrawingData
-
-typedef enum { // separate each type into own array for data-orientation
-	OUTPOST_SIMPLE,
-	OUTPOST_MORTAR,
-	OUTPOST_PIERCE,
-} OutpostType;
-
-typedef struct {
-	float health;
-	float seconds_since_last_shot;
-	OutpostType type;
-} OutpostLogic;
-
-typedef struct {
-	Vector2 position;
-	Vector2 turret_direction;
-} OutpostPhysics;
-
-typedef struct {
-	Rectangle base_destination_rectangle;
-	Rectangle turret_atlas_source_rectangle;
-	Rectangle turret_destination_rectangle;
-	float turret_angle;
-} OutpostDrawData;
+#define QUICKSAVE_SNAPSHOT_PATH "quicksave.snapshot" // F5 saves, F9 loads
 
 typedef struct {
 	Rectangle rectangle;
@@ -66,14 +30,6 @@ typedef struct {
 	char *text;
 } TextButtonSpecification;
 
-typedef struct {
-	Vector2 outpost_position;
-	Vector2 tank_position;
-	Vector2 initial_direction;
-	float seconds_remaining;
-	uint8_t type;
-} ShotAnimation;
-
 
 
 
@@ -87,9 +43,10 @@ typedef struct {
 	Vector2 tanks_velocity;
 	Rectangle *text_button_specifications_original_rectangles;
 	Rectangle music_toggle_button_specification_original_rectangle;
-	Music background_music;
+	AudioThread *audio;
+	bool is_music_on;
 	float tanks_seconds_since_last_tick; // move to TitleScreenDrawData
-	uint8_t tanks_count;
+	uint32_t tanks_count;
 	uint8_t text_button_specifications_count;
 } TitleScreenState;
 
@@ -99,56 +56,18 @@ typedef struct {
 	TankDrawData *tanks_draw_data;
 	TextButtonSpecification *text_button_specifications;
 	TextButtonSpecification music_toggle_button_specification;
-	char *highscore_text;
+	TextCache *text_cache; // For the buttons, whose text and size change
+	BakedText title_text;
+	BakedText highscore_text;
 	float highscore_text_splash_time;
 	uint16_t tanks_texture_x_offset;
-	uint8_t tanks_count;
+	uint32_t tanks_count;
 	uint8_t text_button_specifications_count;
 } TitleScreenDrawData;
 
 
 
 
-typedef struct {
-	OutpostLogic *outposts_logic;
-	TankLogic *tanks_logic;
-	Vector2 *tanks_path_points;
-
-	float seconds_till_next_wave;
-	uint8_t current_wave_number;
-	uint8_t current_wave_tanks_spawned_count;
-
-	uint8_t outposts_count;
-	uint8_t tanks_count;
-	uint8_t tanks_path_points_count;
-} GameplayLogic;
-
-typedef struct {
-	OutpostPhysics *outposts_physics;
-	TankPhysics *tanks_physics;
-	uint8_t outposts_count;
-	uint8_t tanks_count;
-} GameplayPhysics;
-
-typedef struct {
-	Texture2D texture_atlas;
-	OutpostDrawData *outposts_draw_data;
-	TankDrawData *tanks_draw_data;
-	ShotAnimation *outpost_shot_animations;
-	ShotAnimation *tank_shot_animations;
-	Vector2 *tanks_path_points;
-	float tanks_seconds_since_last_tick;
-	uint16_t tanks_texture_x_offset;
-	uint8_t outposts_count;
-	uint8_t outpost_shot_animations_count;
-	uint8_t tanks_count;
-	uint8_t tank_shot_animations_count;
-	uint8_t tanks_path_points_count;
-} GameplayDrawData;
-
-
-
-
 void drawBackground(Texture2D texture_atlas)
 {
 	DrawTexturePro(
@@ -174,18 +93,17 @@ void drawBackground(Texture2D texture_atlas)
 
 
 
-void drawHighscore(char highscore_text[], Texture2D texture_atlas, float scale)
+#define HIGHSCORE_FONT_SIZE 100
+#define HIGHSCORE_BAKED_FONT_SIZE 120 // The largest the splash gets, so it's only ever scaled down
+void drawHighscore(BakedText const *highscore_text, Texture2D texture_atlas, float scale)
 {
-	uint8_t font_size = 100 * scale;
-	DrawTextPro(
-		(Font) {},
+	float text_scale = scale * HIGHSCORE_FONT_SIZE / HIGHSCORE_BAKED_FONT_SIZE;
+	drawBakedText(
 		highscore_text,
 		(Vector2) {1350, 400},
-		(Vector2) {MeasureText(highscore_text, font_size) / 2,
-		font_size / 2},
+		(Vector2) {highscore_text->size.x * text_scale / 2, highscore_text->size.y * text_scale / 2},
 		-30,
-		font_size,
-		font_size / 10,
+		text_scale,
 		GOLD
 	);
 #define SOYJAK_ATLAS_SOURCE_RECTANGLE\
@@ -251,6 +169,7 @@ void enlargeTextButton(TextButtonSpecification *draw_data, Rectangle const *orig
 }
 
 #define TITLE_SCREEN_SPAWN_PADDING 150
+#define TITLE_SCREEN_TANKS_SPACING 60 // Under a tank's length, for a crowd of some 500 that may just overlap
 #define HIGHSCORE_TEXT_SPLASH_FREQUENCY 1.f
 void updateMetaStateAndTitleScreen(MetaState *meta_state, TitleScreenState *title_screen_state, TitleScreenDrawData *title_screen_draw_data)
 {
@@ -266,7 +185,7 @@ void updateMetaStateAndTitleScreen(MetaState *meta_state, TitleScreenState *titl
 	}
 	title_screen_state->tanks_seconds_since_last_tick += frame_time;
 
-	for (uint8_t i = 0; i < title_screen_state->tanks_count; i++) {
+	for (uint32_t i = 0; i < title_screen_state->tanks_count; i++) {
 		title_screen_draw_data->tanks_draw_data[i].destination_rectangle.x += title_screen_state->tanks_velocity.x * frame_time;
 		title_screen_draw_data->tanks_draw_data[i].destination_rectangle.y += title_screen_state->tanks_velocity.y * frame_time;
 
@@ -292,12 +211,11 @@ void updateMetaStateAndTitleScreen(MetaState *meta_state, TitleScreenState *titl
 	// Music toggle button
 	if (CheckCollisionPointRec(GetMousePosition(), title_screen_state->music_toggle_button_specification_original_rectangle)) {
 		if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
-			if (IsMusicStreamPlaying(title_screen_state->background_music)) {
-				StopMusicStream(title_screen_state->background_music);
-				strcpy(title_screen_draw_data->music_toggle_button_specification.text, "Toggle Music [Off]");
-			} else {
-				PlayMusicStream(title_screen_state->background_music);
-				strcpy(title_screen_draw_data->music_toggle_button_specification.text, "Toggle Music [On]");
+			// Only queued for the audio thread; a full queue drops the click and leaves the button as it was
+			bool is_music_on = !title_screen_state->is_music_on;
+			if (sendAudioCommand(title_screen_state->audio, (AudioCommand) {.type = is_music_on ? AUDIO_COMMAND_PLAY_MUSIC : AUDIO_COMMAND_PAUSE_MUSIC})) {
+				title_screen_state->is_music_on = is_music_on;
+				strcpy(title_screen_draw_data->music_toggle_button_specification.text, is_music_on ? "Toggle Music [On]" : "Toggle Music [Off]");
 			}
 		}
 
@@ -312,17 +230,20 @@ void updateMetaStateAndTitleScreen(MetaState *meta_state, TitleScreenState *titl
 	title_screen_draw_data->highscore_text_splash_time += frame_time;
 }
 
-void drawTextButton(TextButtonSpecification const *draw_data)
+void drawTextButton(TextButtonSpecification const *draw_data, TextCache *text_cache)
 {
 #define BUTTON_TEXT_SCALE_FACTOR 2.f / 3.f
 	DrawRectangleRec(draw_data->rectangle, draw_data->rectangle_color);
 
+	// Hovering only ever switches between two sizes, so both stay cached
 	uint8_t font_size = draw_data->rectangle.height * BUTTON_TEXT_SCALE_FACTOR;
-	DrawText(
-		draw_data->text,
-		draw_data->rectangle.x + (draw_data->rectangle.width - MeasureText(draw_data->text, font_size)) / 2,
-		draw_data->rectangle.y + draw_data->rectangle.height * ((1 - BUTTON_TEXT_SCALE_FACTOR) / 2),
-		font_size,
+	TextLayout const *layout = getTextLayout(text_cache, draw_data->text, font_size);
+	drawTextLayout(
+		layout,
+		(Vector2) { // Whole pixels, as DrawText() had them
+			(int) (draw_data->rectangle.x + (draw_data->rectangle.width - (int) layout->size.x) / 2),
+			(int) (draw_data->rectangle.y + draw_data->rectangle.height * ((1 - BUTTON_TEXT_SCALE_FACTOR) / 2)),
+		},
 		draw_data->text_color
 	);
 #undef BUTTON_TEXT_SCALE_FACTOR
@@ -330,324 +251,40 @@ void drawTextButton(TextButtonSpecification const *draw_data)
 
 void drawTitleScreen(TitleScreenDrawData const *title_screen_draw_data)
 {
-	drawBackground(title_screen_draw_data->texture_atlas);
+	if (title_screen_draw_data->texture_atlas.id != 0)
+		drawBackground(title_screen_draw_data->texture_atlas);
+	else
+		ClearBackground(title_screen_draw_data->background_color); // Placeholder while the atlas loads
 
-	for (uint8_t i = 0; i < title_screen_draw_data->tanks_count; i++)
+	for (uint32_t i = 0; i < title_screen_draw_data->tanks_count; i++)
 		drawTank(&title_screen_draw_data->tanks_draw_data[i], title_screen_draw_data->texture_atlas);
 
-	DrawText("Citadel", 100, 100, 350, WHITE);
+	drawBakedText(&title_screen_draw_data->title_text, (Vector2) {100, 100}, (Vector2) {0, 0}, 0, 1, WHITE);
 
 	for (uint8_t i = 0; i < title_screen_draw_data->text_button_specifications_count; i++)
-		drawTextButton(&title_screen_draw_data->text_button_specifications[i]);
-	drawTextButton(&title_screen_draw_data->music_toggle_button_specification);
+		drawTextButton(&title_screen_draw_data->text_button_specifications[i], title_screen_draw_data->text_cache);
+	drawTextButton(&title_screen_draw_data->music_toggle_button_specification, title_screen_draw_data->text_cache);
 
-	drawHighscore("Highscore: ", title_screen_draw_data->texture_atlas, 1 + 0.2f * sinf(HIGHSCORE_TEXT_SPLASH_FREQUENCY * 2 * M_PI * title_screen_draw_data->highscore_text_splash_time));
+	drawHighscore(&title_screen_draw_data->highscore_text, title_screen_draw_data->texture_atlas, 1 + 0.2f * sinf(HIGHSCORE_TEXT_SPLASH_FREQUENCY * 2 * M_PI * title_screen_draw_data->highscore_text_splash_time));
 }
 
 
 
 
-void evictElement(void *array, uint8_t length, size_t element_size, uint8_t index)
-{
-	uint8_t *byte_array = (uint8_t *) array;
-	//memmove(byte_array + index * element_size, byte_array + (index + 1) * element_size, (length - (index + 1)) * element_size); // TODO why does this segfault?
-
-	for (uint8_t i = index; i < length - 1; i++)
-		memcpy(byte_array + index * element_size, byte_array + (index + 1) * element_size, element_size);
-}
 
-#define GREEN_TANK_ATLAS_SOURCE_RECTANGLE\
+#define OUTPOST_BASE_ATLAS_SOURCE_RECTANGLE\
 	((Rectangle) {\
-	 	.x = 0,\
-		.y = 0,\
-		.width = 63,\
-		.height = 83,\
-	 })
-
-#define BLUE_TANK_ATLAS_SOURCE_RECTANGLE\
-	((Rectangle) {\
-	 	.x = 0,\
-		.y = 100,\
-		.width = 62,\
-		.height = 67,\
-	 })
-
-#define RED_TANK_ATLAS_SOURCE_RECTANGLE\
-	((Rectangle) {\
-	 	.x = 0,\
-		.y = 182,\
-		.width = 59,\
-		.height = 68,\
-	 })
-
-#define TANK_SPEED 150.f
-
-#define OUTPOST_RANGE 300.f
-#define TANK_RANGE 200.f
-
-#define OUTPOST_SIMPLE_SHOT_COOLDOWN_SECONDS 0.5f
-#define OUTPOST_MORTAR_SHOT_COOLDOWN_SECONDS 1.5f
-#define OUTPOST_PIERCE_SHOT_COOLDOWN_SECONDS 1.5f
-#define TANK_SHOT_COOLDOWN_SECONDS 0.75f
-
-#define OUTPOST_MAXIMUM_HEALTH 100.f
-#define TANK_MAXIMUM_HEALTH 100.f
-
-#define OUTPOST_SIMPLE_ANIMATION_DURATION_SECONDS 0.25f
-#define OUTPOST_MORTAR_ANIMATION_DURATION_SECONDS 0.75f
-#define OUTPOST_PIERCE_ANIMATION_DURATION_SECONDS 0.75f
-
-void updateGameplayLogic(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data)
-{
-	float frame_time = GetFrameTime();
-
-	if (gameplay_logic->seconds_till_next_wave < 0.f) {
-		if (gameplay_logic->current_wave_tanks_spawned_count < (1 << gameplay_logic->current_wave_number)) {
-			if (
-				gameplay_logic->tanks_count == 0 ||
-				Vector2Distance(
-					gameplay_physics->tanks_physics[gameplay_logic->tanks_count - 1].position,
-					gameplay_logic->tanks_path_points[0]
-				) > 200.f * (1 + (float) rand() / RAND_MAX)
-			) {
-				gameplay_logic->tanks_logic[gameplay_logic->tanks_count] = (TankLogic) {
-					.health = TANK_MAXIMUM_HEALTH,
-					.seconds_since_last_shot = TANK_SHOT_COOLDOWN_SECONDS,
-					.type = rand() % 3,
-				};
-				gameplay_physics->tanks_physics[gameplay_logic->tanks_count] = (TankPhysics) {
-					.position = gameplay_logic->tanks_path_points[0],
-					.velocity = Vector2Subtract(gameplay_logic->tanks_path_points[1], gameplay_logic->tanks_path_points[0]), // Rescaled every frame
-				};
-				switch (gameplay_logic->tanks_logic[gameplay_logic->tanks_count].type) {
-				case 0:
-					gameplay_draw_data->tanks_draw_data[gameplay_logic->tanks_count].atlas_source_rectangle = GREEN_TANK_ATLAS_SOURCE_RECTANGLE;
-					break;
-				case 1:
-					gameplay_draw_data->tanks_draw_data[gameplay_logic->tanks_count].atlas_source_rectangle = BLUE_TANK_ATLAS_SOURCE_RECTANGLE;
-					break;
-				case 2:
-					gameplay_draw_data->tanks_draw_data[gameplay_logic->tanks_count].atlas_source_rectangle = RED_TANK_ATLAS_SOURCE_RECTANGLE;
-					break;
-				}
-				gameplay_draw_data->tanks_draw_data[gameplay_logic->tanks_count].destination_rectangle = (Rectangle) {
-					.width = gameplay_draw_data->tanks_draw_data[gameplay_logic->tanks_count].atlas_source_rectangle.width,
-					.height = gameplay_draw_data->tanks_draw_data[gameplay_logic->tanks_count].atlas_source_rectangle.height,
-				};
-
-				gameplay_logic->tanks_count++;
-				gameplay_physics->tanks_count++;
-				gameplay_draw_data->tanks_count++;
-
-				gameplay_logic->current_wave_tanks_spawned_count++;
-			}
-		} else {
-			gameplay_logic->seconds_till_next_wave = 15.f;
-			gameplay_logic->current_wave_number++;
-			gameplay_logic->current_wave_tanks_spawned_count = 0;
-		}
-	}
-	gameplay_logic->seconds_till_next_wave -= frame_time;
-
-	for (uint8_t i = 0; i < gameplay_logic->outposts_count; i++) {
-		for (uint8_t j = 0; j < gameplay_logic->tanks_count; j++) {
-			if (Vector2Distance(gameplay_physics->tanks_physics[j].position, gameplay_physics->outposts_physics[i].position) < OUTPOST_RANGE) {
-				Vector2 difference = Vector2Subtract(gameplay_physics->tanks_physics[j].position, gameplay_physics->outposts_physics[i].position);
-				gameplay_physics->outposts_physics[i].turret_direction = Vector2Normalize(Vector2Add(
-					gameplay_physics->outposts_physics[i].turret_direction,
-					Vector2Scale(difference, (gameplay_logic->outposts_logic[i].type == OUTPOST_PIERCE ? 0.1f : 0.025f) * frame_time)
-				));
-
-				switch (gameplay_logic->outposts_logic[i].type) {
-				case OUTPOST_SIMPLE:
-					if (gameplay_logic->outposts_logic[i].seconds_since_last_shot < OUTPOST_SIMPLE_SHOT_COOLDOWN_SECONDS)
-						goto next_outpost;
-
-					gameplay_logic->tanks_logic[j].health -= 10.f;
-					gameplay_draw_data->outpost_shot_animations[gameplay_draw_data->outpost_shot_animations_count].seconds_remaining = OUTPOST_SIMPLE_ANIMATION_DURATION_SECONDS;
-					break;
-
-				case OUTPOST_MORTAR:
-					if (gameplay_logic->outposts_logic[i].seconds_since_last_shot < OUTPOST_MORTAR_SHOT_COOLDOWN_SECONDS)
-						goto next_outpost;
-
-					gameplay_logic->tanks_logic[j].health -= 15.f;
-					gameplay_draw_data->outpost_shot_animations[gameplay_draw_data->outpost_shot_animations_count].seconds_remaining = OUTPOST_MORTAR_ANIMATION_DURATION_SECONDS;
-					break;
-
-				case OUTPOST_PIERCE:
-					if (gameplay_logic->outposts_logic[i].seconds_since_last_shot < OUTPOST_PIERCE_SHOT_COOLDOWN_SECONDS)
-						goto next_outpost;
-
-					gameplay_logic->tanks_logic[j].health -= 20.f;
-					gameplay_draw_data->outpost_shot_animations[gameplay_draw_data->outpost_shot_animations_count].seconds_remaining = OUTPOST_PIERCE_ANIMATION_DURATION_SECONDS;
-					break;
-				}
-
-				gameplay_draw_data->outpost_shot_animations[gameplay_draw_data->outpost_shot_animations_count].outpost_position = gameplay_physics->outposts_physics[i].position;
-				gameplay_draw_data->outpost_shot_animations[gameplay_draw_data->outpost_shot_animations_count].tank_position = gameplay_physics->tanks_physics[j].position;
-				gameplay_draw_data->outpost_shot_animations[gameplay_draw_data->outpost_shot_animations_count].initial_direction = gameplay_physics->outposts_physics[i].turret_direction;
-				gameplay_draw_data->outpost_shot_animations[gameplay_draw_data->outpost_shot_animations_count].type = gameplay_logic->outposts_logic[i].type;
-
-				gameplay_draw_data->outpost_shot_animations_count++;
-				gameplay_logic->outposts_logic[i].seconds_since_last_shot = 0.f;
-				goto next_outpost;
-			}
-		}
-next_outpost: {}
-	}
-
-	for (uint8_t i = 0; i < gameplay_logic->tanks_count; i++) {
-		if (gameplay_logic->tanks_logic[i].seconds_since_last_shot < TANK_SHOT_COOLDOWN_SECONDS)
-			continue;
-
-		for (uint8_t j = 0; j < gameplay_logic->outposts_count; j++) {
-			if (Vector2Distance(gameplay_physics->outposts_physics[j].position, gameplay_physics->tanks_physics[i].position) < TANK_RANGE) {
-				gameplay_logic->outposts_logic[j].health -= 15.f;
-				gameplay_draw_data->tank_shot_animations[gameplay_draw_data->tank_shot_animations_count++] = (ShotAnimation) {
-					.outpost_position = gameplay_physics->outposts_physics[j].position,
-					.tank_position = gameplay_physics->tanks_physics[i].position,
-					.initial_direction = Vector2Normalize(gameplay_physics->tanks_physics[i].velocity),
-					.seconds_remaining = 0.2f,
-					.type = gameplay_logic->tanks_logic[i].type,
-				};
-				gameplay_logic->tanks_logic[i].seconds_since_last_shot = 0.f;
-
-				break;
-			}
-		}
-	}
-
-
-	// evict zero health elements
-
-	for (uint8_t i = 0; i < gameplay_logic->outposts_count; i++) {
-		if (gameplay_logic->outposts_logic[i].health < 0.f) {
-			evictElement(gameplay_logic->outposts_logic, gameplay_logic->outposts_count, sizeof (OutpostLogic), i);
-			evictElement(gameplay_physics->outposts_physics, gameplay_logic->outposts_count, sizeof (OutpostPhysics), i);
-			evictElement(gameplay_draw_data->outposts_draw_data, gameplay_logic->outposts_count, sizeof (OutpostDrawData), i);
-			gameplay_logic->outposts_count--;
-			gameplay_physics->outposts_count--;
-			gameplay_draw_data->outposts_count--;
-			break;
-		}
-	}
-
-	for (uint8_t i = 0; i < gameplay_logic->tanks_count; i++) {
-		if (gameplay_logic->tanks_logic[i].health < 0.f) {
-			evictElement(gameplay_logic->tanks_logic, gameplay_logic->outposts_count, sizeof (TankLogic), i);
-			evictElement(gameplay_physics->tanks_physics, gameplay_logic->outposts_count, sizeof (TankPhysics), i);
-			evictElement(gameplay_draw_data->tanks_draw_data, gameplay_logic->outposts_count, sizeof (TankDrawData), i);
-			gameplay_logic->tanks_count--;
-			gameplay_physics->tanks_count--;
-			gameplay_draw_data->tanks_count--;
-			break;
-		}
-	}
-
-
-	for (uint8_t i = 0; i < gameplay_logic->tanks_count; i++) {
-		if (Vector2Distance(gameplay_physics->tanks_physics[i].position,  gameplay_logic->tanks_path_points[gameplay_logic->tanks_path_points_count - 1]) < 60.f) {
-			Vector2 displacement = Vector2Subtract(gameplay_physics->tanks_physics[i].position, gameplay_logic->tanks_path_points[gameplay_logic->tanks_path_points_count - 1]);
-			gameplay_physics->tanks_physics[i].acceleration = Vector2Scale(gameplay_physics->tanks_physics[i].velocity, -5.f);
-		} else {
-			gameplay_physics->tanks_physics[i].velocity = Vector2ClampValue(gameplay_physics->tanks_physics[i].velocity, TANK_SPEED, TANK_SPEED);
-		}
-
-		if (Vector2Distance(gameplay_physics->tanks_physics[i].position, gameplay_logic->tanks_path_points[gameplay_logic->tanks_logic[i].path_segment_index + 1]) < 60.f) {
-			Vector2 difference = Vector2Subtract(
-				gameplay_logic->tanks_path_points[gameplay_logic->tanks_logic[i].path_segment_index + 2],
-				gameplay_logic->tanks_path_points[gameplay_logic->tanks_logic[i].path_segment_index + 1]
-			);
-			gameplay_physics->tanks_physics[i].acceleration = Vector2Scale(difference, 600.f / Vector2Length(difference));
-
-			gameplay_logic->tanks_logic[i].path_segment_index++;
-		}
-	}
-
-	for (uint8_t i = 0; i < gameplay_logic->outposts_count; i++)
-		gameplay_logic->outposts_logic[i].seconds_since_last_shot += frame_time;
-	for (uint8_t i = 0; i < gameplay_logic->tanks_count; i++)
-		gameplay_logic->tanks_logic[i].seconds_since_last_shot += frame_time;
-}
-
-void updateGameplayPhysics(GameplayPhysics *gameplay_physics)
-{
-	for (uint8_t i = 0; i < gameplay_physics->tanks_count; i++) {
-		gameplay_physics->tanks_physics[i].velocity.x += gameplay_physics->tanks_physics[i].acceleration.x * GetFrameTime();
-		gameplay_physics->tanks_physics[i].velocity.y += gameplay_physics->tanks_physics[i].acceleration.y * GetFrameTime();
-
-		gameplay_physics->tanks_physics[i].position.x += gameplay_physics->tanks_physics[i].velocity.x * GetFrameTime();
-		gameplay_physics->tanks_physics[i].position.y += gameplay_physics->tanks_physics[i].velocity.y * GetFrameTime();
-	}
-}
-
-void updateGameplayDrawData(GameplayDrawData *gameplay_draw_data, GameplayPhysics const *gameplay_physics)
-{
-	float frame_time = GetFrameTime();
-
-	if (gameplay_draw_data->tanks_seconds_since_last_tick > 0.05f) {
-		if (gameplay_draw_data->tanks_texture_x_offset == 0)
-			gameplay_draw_data->tanks_texture_x_offset = 100;
-		else
-			gameplay_draw_data->tanks_texture_x_offset = 0;
-
-		gameplay_draw_data->tanks_seconds_since_last_tick = 0.f;
-	}
-	gameplay_draw_data->tanks_seconds_since_last_tick += frame_time;
-
-	// update animations (outpost and tank)
-
-	for (uint8_t i = 0; i < gameplay_draw_data->outpost_shot_animations_count; i++)
-		gameplay_draw_data->outpost_shot_animations[i].seconds_remaining -= frame_time;
-
-	for (uint8_t i = 0; i < gameplay_draw_data->tank_shot_animations_count; i++)
-		gameplay_draw_data->tank_shot_animations[i].seconds_remaining -= frame_time;
-
-
-	// evict expired animations (outpost and tank)
-
-	for (uint8_t i = 0; i < gameplay_draw_data->outpost_shot_animations_count; i++) {
-		if (gameplay_draw_data->outpost_shot_animations[i].seconds_remaining < 0.f) {
-			evictElement(gameplay_draw_data->outpost_shot_animations, gameplay_draw_data->outpost_shot_animations_count, sizeof (ShotAnimation), i);
-			gameplay_draw_data->outpost_shot_animations_count--;
-			break;
-		}
-	}
-
-	for (uint8_t i = 0; i < gameplay_draw_data->tank_shot_animations_count; i++) {
-		if (gameplay_draw_data->tank_shot_animations[i].seconds_remaining < 0.f) {
-			evictElement(gameplay_draw_data->tank_shot_animations, gameplay_draw_data->tank_shot_animations_count, sizeof (ShotAnimation), i);
-			gameplay_draw_data->tank_shot_animations_count--;
-			break;
-		}
-	}
-
-
-	for (uint8_t i = 0; i < gameplay_draw_data->outposts_count; i++)
-		gameplay_draw_data->outposts_draw_data[i].turret_angle = atan2f(gameplay_physics->outposts_physics[i].turret_direction.y, gameplay_physics->outposts_physics[i].turret_direction.x) * 180.f / M_PI;
-
-	for (uint8_t i = 0; i < gameplay_draw_data->tanks_count; i++) {
-		if (Vector2Length(gameplay_physics->tanks_physics[i].velocity) > 1)
-			gameplay_draw_data->tanks_draw_data[i].atlas_source_rectangle.x = gameplay_draw_data->tanks_texture_x_offset;
-
-		gameplay_draw_data->tanks_draw_data[i].destination_rectangle.x = gameplay_physics->tanks_physics[i].position.x;
-		gameplay_draw_data->tanks_draw_data[i].destination_rectangle.y = gameplay_physics->tanks_physics[i].position.y;
-
-		gameplay_draw_data->tanks_draw_data[i].angle = atan2f(gameplay_physics->tanks_physics[i].velocity.y, gameplay_physics->tanks_physics[i].velocity.x) * 180.f / M_PI - 90.f;
-	}
-}
+		.x = 0,\
+		.y = 250,\
+		.width = 26,\
+		.height = 26,\
+	})
 
 void drawOutpostBase(OutpostDrawData const *draw_data, Texture2D texture_atlas, Color tint)
 {
 	DrawTexturePro(
 		texture_atlas,
-		(Rectangle) {
- 			.x = 0,
-			.y = 250,
-			.width = 26,
-			.height = 26,
-		},
+		OUTPOST_BASE_ATLAS_SOURCE_RECTANGLE,
 		draw_data->base_destination_rectangle,
 		(Vector2) {
 			draw_data->base_destination_rectangle.width / 2,
@@ -673,34 +310,109 @@ void drawOutpostTurret(OutpostDrawData const *draw_data, Texture2D texture_atlas
 	);
 }
 
-#define TANKS_PATH_THICKNESS 75
-
-void drawGameplay(GameplayLogic const *gameplay_logic, GameplayPhysics const *gameplay_physics, GameplayDrawData const *gameplay_draw_data)
+// The background and path never change during a game, so composite them
+// once, at the window's actual pixel size; call again whenever that changes
+void bakeGameplayBackground(GameplayDrawData *gameplay_draw_data)
 {
-	drawBackground(gameplay_draw_data->texture_atlas);
+	if (gameplay_draw_data->background.id != 0)
+		UnloadRenderTexture(gameplay_draw_data->background);
+
+	gameplay_draw_data->background = LoadRenderTexture(GetRenderWidth(), GetRenderHeight());
+	SetTextureFilter(gameplay_draw_data->background.texture, TEXTURE_FILTER_BILINEAR);
 
-	for (uint8_t i = 0; i < gameplay_draw_data->tanks_path_points_count - 1; i++) { // Replace with baked background texture
+	BeginTextureMode(gameplay_draw_data->background);
+	BeginMode2D((Camera2D) {
+		.zoom = (float) GetRenderWidth() / WINDOW_WIDTH, // Draw in window coordinates as usual
+	});
+
+	drawBackground(gameplay_draw_data->texture_atlas);
+	for (uint8_t i = 0; i < gameplay_draw_data->tanks_path_points_count - 1; i++) {
 		DrawLineEx(gameplay_draw_data->tanks_path_points[i], gameplay_draw_data->tanks_path_points[i + 1], TANKS_PATH_THICKNESS, BEIGE);
 		DrawCircleV(gameplay_draw_data->tanks_path_points[i + 1], TANKS_PATH_THICKNESS / 2, BEIGE);
 	}
 
-	for (uint8_t i = 0; i < gameplay_draw_data->outposts_count; i++)
-		drawOutpostBase(&gameplay_draw_data->outposts_draw_data[i], gameplay_draw_data->texture_atlas, WHITE);
+	EndMode2D();
+	EndTextureMode();
+}
 
-	for (uint8_t i = 0; i < gameplay_draw_data->tanks_count; i++)
-		drawTank(&gameplay_draw_data->tanks_draw_data[i], gameplay_draw_data->texture_atlas);
+// Mirrors gameplay_logic->placement_map as a tint over the map, rebuilt only when it changes
+void refreshPlacementOverlay(GameplayDrawData *gameplay_draw_data, PlacementMap const *placement_map)
+{
+	if (gameplay_draw_data->placement_overlay.id != 0 && gameplay_draw_data->placement_overlay_revision == placement_map->revision)
+		return;
+
+	Color *pixels = malloc(placement_map->width * placement_map->height * sizeof (Color));
+	if (pixels == NULL)
+		return;
+
+	for (uint32_t i = 0; i < (uint32_t) placement_map->width * placement_map->height; i++)
+		pixels[i] = placement_map->blockers_counts[i] == 0 ? (Color) {0, 228, 48, 40} : (Color) {230, 41, 55, 40};
+
+	if (gameplay_draw_data->placement_overlay.id == 0) {
+		gameplay_draw_data->placement_overlay = LoadTextureFromImage((Image) {
+			.data = pixels,
+			.width = placement_map->width,
+			.height = placement_map->height,
+			.mipmaps = 1,
+			.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+		});
+	} else {
+		UpdateTexture(gameplay_draw_data->placement_overlay, pixels);
+	}
 
-	// draw animations (outpost and tank)
+	free(pixels);
+	gameplay_draw_data->placement_overlay_revision = placement_map->revision;
+}
 
-	for (uint8_t i = 0; i < gameplay_draw_data->outpost_shot_animations_count; i++) {
-		Vector2 outpost_position = gameplay_draw_data->outpost_shot_animations[i].outpost_position;
-		Vector2 tank_position = gameplay_draw_data->outpost_shot_animations[i].tank_position;
-		Vector2 initial_direction = gameplay_draw_data->outpost_shot_animations[i].initial_direction;
+void drawGameplay(GameplayLogic const *gameplay_logic, GameplayPhysics const *gameplay_physics, GameplayDrawData const *gameplay_draw_data, SpriteBatch *sprite_batch, TrailMesh *trail_mesh)
+{
+	DrawTexturePro(
+		gameplay_draw_data->background.texture,
+		(Rectangle) { // Render textures are stored bottom-up
+			.width = gameplay_draw_data->background.texture.width,
+			.height = -gameplay_draw_data->background.texture.height,
+		},
+		(Rectangle) {
+			.width = WINDOW_WIDTH,
+			.height = WINDOW_HEIGHT,
+		},
+		(Vector2) {0, 0},
+		0,
+		WHITE
+	);
+
+	// Every atlas sprite goes out in one batch, layered bases, tanks, turrets
+
+	for (uint32_t i = 0; i < gameplay_draw_data->outposts_count; i++) {
+		OutpostDrawData const *outpost_draw_data = &gameplay_draw_data->outposts_draw_data[i];
+		pushSprite(sprite_batch, SPRITE_LAYER_OUTPOST_BASES, OUTPOST_BASE_ATLAS_SOURCE_RECTANGLE, outpost_draw_data->base_destination_rectangle, 0, WHITE);
+		pushSprite(sprite_batch, SPRITE_LAYER_OUTPOST_TURRETS, outpost_draw_data->turret_atlas_source_rectangle, outpost_draw_data->turret_destination_rectangle, outpost_draw_data->turret_angle, WHITE);
+	}
+
+	for (uint32_t i = 0; i < gameplay_draw_data->tanks_count; i++) {
+		TankDrawData const *tank_draw_data = &gameplay_draw_data->tanks_draw_data[i];
+		pushSprite(sprite_batch, SPRITE_LAYER_TANKS, tank_draw_data->atlas_source_rectangle, tank_draw_data->destination_rectangle, tank_draw_data->angle, WHITE);
+	}
+
+	flushSpriteBatch(sprite_batch);
+
+	// draw animations (outpost and tank), tessellated into one mesh
+
+	for (uint32_t k = 0; k < gameplay_draw_data->outpost_shot_animations.count; k++) {
+		ShotAnimation const *animation = getParticle(&gameplay_draw_data->outpost_shot_animations, k);
+
+		// The ring keeps shorter animations until its lifetime is up
+		float fraction_remaining = animation->duration_seconds - getParticleAge(&gameplay_draw_data->outpost_shot_animations, k, gameplay_draw_data->seconds_elapsed);
+		if (fraction_remaining < 0.f)
+			continue;
+
+		Vector2 outpost_position = animation->outpost_position;
+		Vector2 tank_position = animation->tank_position;
+		Vector2 initial_direction = animation->initial_direction;
 
 		float distance = Vector2Distance(tank_position, outpost_position);
-		float fraction_remaining = gameplay_draw_data->outpost_shot_animations[i].seconds_remaining;
 
-		OutpostType outpost_type = gameplay_draw_data->outpost_shot_animations[i].type;
+		OutpostType outpost_type = animation->type;
 		switch (outpost_type) {
 		case OUTPOST_SIMPLE:
 		case OUTPOST_MORTAR:
@@ -736,38 +448,44 @@ void drawGameplay(GameplayLogic const *gameplay_logic, GameplayPhysics const *ga
 					.a = 127.f * sqrtf(fraction_remaining),
 				};
 
-				DrawCircleV(tank_position, 150.f * sqrtf(fraction_remaining), color);
+				pushTrailDisc(trail_mesh, tank_position, 150.f * sqrtf(fraction_remaining), color, color);
 			}
-			DrawSplineBezierQuadratic(
-				(Vector2 []) {outpost_position, control, tank_position},
-				3,
-				10,
-				color
-			);
+
+			// The tail fades ahead of the head, so the trail seems to reach into the tank
+			Color tail_color = color;
+			tail_color.a *= fraction_remaining;
+			pushTrailBezier(trail_mesh, outpost_position, control, tank_position, 10, tail_color, color);
 			break;
 
 		case OUTPOST_PIERCE:
-			DrawLineEx(
+			Color ray_color = {
+				.r = SKYBLUE.r,
+				.g = SKYBLUE.g,
+				.b = SKYBLUE.b,
+				.a = 255.f * sqrtf(fraction_remaining),
+			};
+			pushTrailLine(
+				trail_mesh,
 				outpost_position,
 				Vector2Add(
 					outpost_position,
 					Vector2Scale(Vector2Subtract(tank_position, outpost_position), OUTPOST_RANGE * 1.5f / distance)
 				),
 				5.f * (2.f + sinf(10.f * M_PI * fraction_remaining)),
-				(Color) {
-					.r = SKYBLUE.r,
-					.g = SKYBLUE.g,
-					.b = SKYBLUE.b,
-					.a = 255.f * sqrtf(fraction_remaining),
-				}
+				ray_color,
+				ray_color
 			);
 			break;
+
+		case OUTPOST_TYPES_COUNT:
+			break;
 		}
 	}
 
-	for (uint8_t i = 0; i < gameplay_draw_data->outposts_count; i++) {
-		drawOutpostTurret(&gameplay_draw_data->outposts_draw_data[i], gameplay_draw_data->texture_atlas, WHITE);
+	trail_mesh->pixels_per_unit = (float) GetRenderWidth() / WINDOW_WIDTH;
+	flushTrailMesh(trail_mesh);
 
+	for (uint32_t i = 0; i < gameplay_draw_data->outposts_count; i++) {
 		if (gameplay_logic->outposts_logic[i].health == OUTPOST_MAXIMUM_HEALTH)
 			continue;
 
@@ -781,7 +499,7 @@ void drawGameplay(GameplayLogic const *gameplay_logic, GameplayPhysics const *ga
 		);
 	}
 
-	for (uint8_t i = 0; i < gameplay_draw_data->tanks_count; i++) {
+	for (uint32_t i = 0; i < gameplay_draw_data->tanks_count; i++) {
 		if (gameplay_logic->tanks_logic[i].health == TANK_MAXIMUM_HEALTH)
 			continue;
 
@@ -814,6 +532,10 @@ typedef struct {
 
 	uint8_t selected_outpost;
 
+	// Clicks wait here for the next tick, so they land on a tick boundary and can be replayed
+	GameplayCommand pending_commands[8];
+	uint8_t pending_commands_count;
+
 	uint32_t score; // move to GameplayLogic?
 	uint32_t coins;
 } GameUiLogic; // merge with GameplayLogic?
@@ -844,102 +566,20 @@ bool isMouseHoveringOverTextureButton(Rectangle specification_destination_rectan
 	) < specification_destination_rectangle.width / 2;
 }
 
-#define SQRT_2_F 1.414213f
-bool canOutpostBePlaced(Vector2 position, Vector2 *path_points, uint8_t path_points_count, OutpostDrawData *outposts_draw_data, uint8_t outposts_count)
-{
-	for (uint8_t i = 0; i < path_points_count - 1; i++) {
-		float cos = Vector2DotProduct(
-			Vector2Normalize(Vector2Subtract(position, path_points[i])),
-			Vector2Normalize(Vector2Subtract(path_points[i + 1], path_points[i]))
-		);
-		float length = Vector2Length(Vector2Subtract(position, path_points[i]));
-		if (
-			(
-				cos > 0 &&
-				length * cos < Vector2Length(Vector2Subtract(path_points[i + 1], path_points[i])) &&
-				length * sqrt(1 - cos * cos) < TANKS_PATH_THICKNESS / 2 + 75.f / SQRT_2_F
-			) ||
-			Vector2Distance(position, path_points[i + 1]) < TANKS_PATH_THICKNESS / 2 + 75.f / SQRT_2_F
-		)
-			return false;
-	}
-
-	for (uint8_t i = 0; i < outposts_count; i++) {
-		if (CheckCollisionRecs(
-			(Rectangle) {
-				.x = position.x,
-				.y = position.y,
-				.width = 75.f,
-				.height = 75.f,
-			},
-			outposts_draw_data[i].base_destination_rectangle
-		))
-			return false;
-	}
-
-	return true;
-}
-
-#define SQRT_3_F 1.732050f
-void placeOutpost(OutpostType type, Vector2 position, OutpostLogic *logic, OutpostPhysics *physics, OutpostDrawData *draw_data)
-{
-	*logic = (OutpostLogic) {
-		.health = 100,
-		.type = type,
-	};
-
-	*physics = (OutpostPhysics) {
-		.position = position,
-		.turret_direction = {SQRT_3_F / 2.f, -1.f / 2.f},
-	};
-
-	*draw_data = (OutpostDrawData) {
-		.base_destination_rectangle = {
-			.x = position.x,
-			.y = position.y,
-			.width = 75,
-			.height = 75,
-		},
-		.turret_atlas_source_rectangle = {
-			.x = 30 * type,
-			.y = 280,
-			.width = 30,
-			.height = 11,
-		},
-		.turret_destination_rectangle = {
-			.x = position.x,
-			.y = position.y,
-			.width = 75,
-			.height = 30,
-		},
-		.turret_angle = -30,
-	};
-}
 
-void updateGameUiLogic(GameUiLogic *game_ui_logic, GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data)
+void updateGameUiLogic(GameUiLogic *game_ui_logic)
 {
 	game_ui_logic->is_ui_active = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
 
 	if (game_ui_logic->is_ui_active) {
 		if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
 			if (game_ui_logic->selected_outpost < game_ui_logic->outpost_texture_button_specifications_count) {
-				if (canOutpostBePlaced(
-					GetMousePosition(),
-					gameplay_logic->tanks_path_points,
-					gameplay_logic->tanks_path_points_count,
-					gameplay_draw_data->outposts_draw_data,
-					gameplay_logic->outposts_count
-				)) {
-					placeOutpost(
-						game_ui_logic->selected_outpost,
-						GetMousePosition(),
-						gameplay_logic->outposts_logic + gameplay_logic->outposts_count,
-						gameplay_physics->outposts_physics + gameplay_logic->outposts_count, 
-						gameplay_draw_data->outposts_draw_data + gameplay_logic->outposts_count
-					);
-					gameplay_logic->outposts_count++;
-					gameplay_physics->outposts_count++;
-					gameplay_draw_data->outposts_count++;
+				// Validated when applied; the tick fills in
+				if (game_ui_logic->pending_commands_count < sizeof game_ui_logic->pending_commands / sizeof (GameplayCommand)) {
+					game_ui_logic->pending_commands[game_ui_logic->pending_commands_count++] = (GameplayCommand) {
+						.position = GetMousePosition(),
+						.outpost_type = game_ui_logic->selected_outpost,
+					};
 				}
 			} else {
 				for (uint8_t i = 0; i < game_ui_logic->outpost_texture_button_specifications_count; i++) {
@@ -996,8 +636,10 @@ void drawGameUi(GameUiLogic const *game_ui_logic, GameplayLogic const *gameplay_
 				.turret_angle = -30,
 			};
 
+			DrawTexture(gameplay_draw_data->placement_overlay, 0, 0, WHITE);
+
 			Color tint;
-			if (canOutpostBePlaced(mouse_position, gameplay_logic->tanks_path_points, gameplay_logic->tanks_path_points_count, gameplay_draw_data->outposts_draw_data, gameplay_logic->outposts_count)) {
+			if (canOutpostBePlaced(gameplay_logic, mouse_position)) {
 				DrawCircleV(
 					mouse_position,
 					OUTPOST_RANGE,
@@ -1051,7 +693,7 @@ void drawGameUi(GameUiLogic const *game_ui_logic, GameplayLogic const *gameplay_
 			}
 		}
 	} else {
-		for (uint8_t i = 0; i < gameplay_draw_data->outposts_count; i++) {
+		for (uint32_t i = 0; i < gameplay_draw_data->outposts_count; i++) {
 			Rectangle bounding_rectangle = gameplay_draw_data->outposts_draw_data[i].base_destination_rectangle;
 			bounding_rectangle.x -= bounding_rectangle.width / 2;
 			bounding_rectangle.y -= bounding_rectangle.height / 2;
@@ -1115,25 +757,68 @@ void drawGameUi(GameUiLogic const *game_ui_logic, GameplayLogic const *gameplay_
 //        EndDrawing();
 //    }}
 
-int main(void)
+int main(int argc, char *argv[])
 {
+	// --trace <path> records the frame phases, spawns, evictions and asset
+	// loads, and writes them as Chrome trace-event JSON on exit.
+	// --record <path> saves the session's seed, commands and per-tick
+	// checksums on exit; --replay <path> plays such a log back instead of
+	// taking input, checking every tick against it.
+	// --snapshot <path> starts straight into a game saved with F5.
+	char const *trace_path = NULL;
+	char const *record_path = NULL;
+	char const *replay_path = NULL;
+	char const *snapshot_path = NULL;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--trace") == 0)
+			trace_path = argv[++i];
+		else if (strcmp(argv[i], "--record") == 0)
+			record_path = argv[++i];
+		else if (strcmp(argv[i], "--replay") == 0)
+			replay_path = argv[++i];
+		else if (strcmp(argv[i], "--snapshot") == 0)
+			snapshot_path = argv[++i];
+	}
+	if (snapshot_path != NULL && (record_path != NULL || replay_path != NULL)) { // Logs always start from a fresh game
+		fprintf(stderr, "citadel: --snapshot can't be combined with --record or --replay\n");
+		return 1;
+	}
+	if (trace_path != NULL && !startTracing(TRACE_DEFAULT_SPANS_CAPACITY))
+		trace_path = NULL;
+	double startup_start_seconds = getTraceSeconds(); // Time to first frame is always reported
+	if (replay_path != NULL) // A replay takes no input, so there's nothing new to record
+		record_path = NULL;
+
+	ReplayLog replay_log;
+	uint32_t replay_next_command_index = 0;
+	uint32_t replay_mismatches_count = 0;
+	if (replay_path != NULL) {
+		if (!loadReplayLog(&replay_log, replay_path)) {
+			fprintf(stderr, "citadel: can't replay %s\n", replay_path);
+			return 1;
+		}
+	} else {
+		initReplayLog(&replay_log, time(NULL));
+	}
+
 	SetConfigFlags(FLAG_MSAA_4X_HINT); // Antialiasing (must be called before InitWindow())
 	InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Citadel");
 	ToggleFullscreen();
 	SetTargetFPS(60);
 
-	InitAudioDevice();
-	Music background_music = LoadMusicStream("assets/background-music.mp3"); // TODO currently broken on Linux (can't find audio backend)
-	PlayMusicStream(background_music);
+	// Audio and assets come up on a loader thread, from the pack `make pack`
+	// writes or else the source files; until then the title screen shows
+	// its placeholder background, and there's no texture and no music
+	AssetLoader asset_loader;
+	startAssetLoader(&asset_loader, ASSET_PACK_PATH);
+	AudioThread audio = {}; // Started with the music; toggling before that is queued
+	bool are_assets_loaded = false;
+	bool is_first_frame_drawn = false;
 
 
 
 
-#define TITLE_SCREEN_TANKS_COUNT 50
-#define MAXIMUM_OUTPOSTS_COUNT 128
-#define MAXIMUM_TANKS_COUNT 128
-#define MAXIMUM_OUTPOST_SHOT_ANIMATIONS_COUNT 128
-#define MAXIMUM_TANK_SHOT_ANIMATIONS_COUNT 128
+#define TITLE_SCREEN_TANKS_COUNT 4096 // More than fit at TITLE_SCREEN_TANKS_SPACING, so the area decides
 
 	TextButtonSpecification title_screen_text_button_specifications[] = {
 		(TextButtonSpecification) {
@@ -1173,67 +858,54 @@ int main(void)
 	};
 	strcpy(title_screen_music_toggle_button_specification.text, "Toggle Music [On]");
 
-	Texture2D texture_atlas = LoadTexture("assets/texture-atlas.png");
-
-	Vector2 game_state_tanks_path_points[] = {
-		(Vector2) {0, 200},
-		(Vector2) {1000, 200},
-		(Vector2) {1000, 550},
-		(Vector2) {100, 550},
-		(Vector2) {100, 900},
-		(Vector2) {1300, 900},
-		(Vector2) {1300, 100},
-		(Vector2) {1650, 100},
-		(Vector2) {1650, 1000},
-		(Vector2) {1920, 1000},
-	};
-	uint8_t game_state_tanks_path_points_count = sizeof game_state_tanks_path_points / sizeof (Vector2);
+	Texture2D texture_atlas = {}; // Swapped in once loaded; drawing with none is a no-op
 
 
 
 
-	MetaState meta_state = TITLE_SCREEN;
+	MetaState meta_state = replay_path != NULL || snapshot_path != NULL ? GAME : TITLE_SCREEN;
 
 	TitleScreenState title_screen_state = {
 		.tanks_velocity = {50, -50},
 		.text_button_specifications_original_rectangles = malloc(title_screen_text_button_specifications_count * sizeof (Rectangle)),
 		.music_toggle_button_specification_original_rectangle = title_screen_music_toggle_button_specification.rectangle,
-		.background_music = background_music,
+		.audio = &audio,
+		.is_music_on = true,
 		.tanks_count = TITLE_SCREEN_TANKS_COUNT,
 		.text_button_specifications_count = title_screen_text_button_specifications_count,
 	};
 
+	TextCache text_cache = {};
+
 	TitleScreenDrawData title_screen_draw_data = {
 		.texture_atlas = texture_atlas,
 		.background_color = DARKGREEN,
 		.tanks_draw_data = malloc(TITLE_SCREEN_TANKS_COUNT * sizeof (TankDrawData)), // alloca()? free()?
 		.text_button_specifications = title_screen_text_button_specifications,
 		.music_toggle_button_specification = title_screen_music_toggle_button_specification,
+		.text_cache = &text_cache,
 		.tanks_count = TITLE_SCREEN_TANKS_COUNT,
 		.text_button_specifications_count = title_screen_text_button_specifications_count,
 	};
+	bakeText(&title_screen_draw_data.title_text, &text_cache, "Citadel", 350);
+	bakeText(&title_screen_draw_data.highscore_text, &text_cache, "Highscore: ", HIGHSCORE_BAKED_FONT_SIZE);
 
-	GameplayLogic gameplay_logic = {
-		.outposts_logic = malloc(MAXIMUM_OUTPOSTS_COUNT * sizeof (OutpostLogic)),
-		.tanks_logic = malloc(MAXIMUM_TANKS_COUNT * sizeof (TankLogic)),
-		.tanks_path_points = game_state_tanks_path_points,
-		.tanks_path_points_count = game_state_tanks_path_points_count,
-	};
+	GameplayLogic gameplay_logic;
+	GameplayPhysics gameplay_physics;
+	GameplayDrawData gameplay_draw_data;
+	initGameplay(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, game_state_tanks_path_points, game_state_tanks_path_points_count, texture_atlas, replay_log.seed);
+	if (snapshot_path != NULL && !loadGameplaySnapshot(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, snapshot_path))
+		fprintf(stderr, "citadel: can't load %s, starting a new game\n", snapshot_path);
+	bakeGameplayBackground(&gameplay_draw_data);
 
-	GameplayPhysics gameplay_physics = {
-		.outposts_physics = malloc(MAXIMUM_OUTPOSTS_COUNT * sizeof (OutpostPhysics)),
-		.tanks_physics = malloc(MAXIMUM_TANKS_COUNT * sizeof (TankPhysics)),
-	};
+	SpriteBatch sprite_batch;
+	initSpriteBatch(&sprite_batch, texture_atlas, INITIAL_TANKS_CAPACITY + 2 * INITIAL_OUTPOSTS_CAPACITY);
 
-	GameplayDrawData gameplay_draw_data = {
-		.texture_atlas = texture_atlas,
-		.outposts_draw_data = malloc(MAXIMUM_OUTPOSTS_COUNT * sizeof (OutpostDrawData)),
-		.tanks_draw_data = malloc(MAXIMUM_TANKS_COUNT * sizeof (TankDrawData)),
-		.outpost_shot_animations = malloc(MAXIMUM_OUTPOST_SHOT_ANIMATIONS_COUNT * sizeof (ShotAnimation)),
-		.tank_shot_animations = malloc(MAXIMUM_TANK_SHOT_ANIMATIONS_COUNT * sizeof (ShotAnimation)),
-		.tanks_path_points = game_state_tanks_path_points,
-		.tanks_path_points_count = game_state_tanks_path_points_count,
-	};
+	TrailMesh trail_mesh;
+	initTrailMesh(&trail_mesh, 64 * INITIAL_OUTPOSTS_CAPACITY);
+
+	Profiler profiler = {}; // F3 toggles it and its overlay
+	float gameplay_seconds_accumulated = 0.f; // Frame time not yet consumed by fixed-rate ticks
 
 
 
@@ -1291,11 +963,26 @@ int main(void)
 
 
 
-	srand(time(NULL));
+	// Spread out by sampling the whole spawn area full, then taking a random
+	// subset of that, so however many tanks there are, they're never clumped
+	Prng title_screen_prng = seedPrng(time(NULL));
+	Rectangle title_screen_spawn_area = {
+		.x = -TITLE_SCREEN_SPAWN_PADDING,
+		.y = -TITLE_SCREEN_SPAWN_PADDING,
+		.width = WINDOW_WIDTH + TITLE_SCREEN_SPAWN_PADDING * 2,
+		.height = WINDOW_HEIGHT + TITLE_SCREEN_SPAWN_PADDING * 2,
+	};
+	uint32_t title_screen_spawn_points_capacity = getPoissonDiskCapacity(title_screen_spawn_area, TITLE_SCREEN_TANKS_SPACING);
+	Vector2 *title_screen_spawn_points = malloc(title_screen_spawn_points_capacity * sizeof (Vector2));
+	uint32_t title_screen_spawn_points_count = samplePoissonDisk(title_screen_spawn_points, title_screen_spawn_points_capacity, title_screen_spawn_area, TITLE_SCREEN_TANKS_SPACING, &title_screen_prng);
+	title_screen_spawn_points_count = pickPoissonDiskPoints(title_screen_spawn_points, title_screen_spawn_points_count, TITLE_SCREEN_TANKS_COUNT, &title_screen_prng);
+
+	title_screen_state.tanks_count = title_screen_spawn_points_count; // Fewer if they don't all fit
+	title_screen_draw_data.tanks_count = title_screen_spawn_points_count;
 
-	for (uint8_t i = 0; i < TITLE_SCREEN_TANKS_COUNT; i++) {
+	for (uint32_t i = 0; i < title_screen_spawn_points_count; i++) {
 		Rectangle atlas_source_rectangle;
-		switch (rand() % 3) {
+		switch (nextPrngUint32(&title_screen_prng) % 3) {
 		case 0:
 			atlas_source_rectangle = GREEN_TANK_ATLAS_SOURCE_RECTANGLE;
 			break;
@@ -1310,30 +997,15 @@ int main(void)
 		title_screen_draw_data.tanks_draw_data[i] = (TankDrawData) {
 			.atlas_source_rectangle = atlas_source_rectangle,
 			.destination_rectangle = (Rectangle) {
+				.x = title_screen_spawn_points[i].x,
+				.y = title_screen_spawn_points[i].y,
 				.width = atlas_source_rectangle.width,
 				.height = atlas_source_rectangle.height,
 			},
 			.angle = -135,
 		};
-
-respawn:
-		title_screen_draw_data.tanks_draw_data[i].destination_rectangle.x = ((float) rand() / RAND_MAX) * (WINDOW_WIDTH + TITLE_SCREEN_SPAWN_PADDING * 2) - TITLE_SCREEN_SPAWN_PADDING;
-		title_screen_draw_data.tanks_draw_data[i].destination_rectangle.y = ((float) rand() / RAND_MAX) * (WINDOW_HEIGHT + TITLE_SCREEN_SPAWN_PADDING * 2) - TITLE_SCREEN_SPAWN_PADDING;
-
-		for (uint8_t j = 0; j < i; j++) {
-			if (Vector2Distance(
-				(Vector2) {
-					title_screen_draw_data.tanks_draw_data[i].destination_rectangle.x,
-					title_screen_draw_data.tanks_draw_data[i].destination_rectangle.y
-				},
-				(Vector2) {
-					title_screen_draw_data.tanks_draw_data[j].destination_rectangle.x,
-					title_screen_draw_data.tanks_draw_data[j].destination_rectangle.y
-				}
-			) < TITLE_SCREEN_SPAWN_PADDING)
-				goto respawn;
-		}
 	}
+	free(title_screen_spawn_points);
 
 	for (uint8_t i = 0; i < title_screen_text_button_specifications_count; i++)
 		title_screen_state.text_button_specifications_original_rectangles[i] = title_screen_text_button_specifications[i].rectangle;
@@ -1342,7 +1014,32 @@ respawn:
 
 
 	while(!WindowShouldClose()) {
-		UpdateMusicStream(background_music);
+		double frame_start_seconds = beginTraceSpan();
+
+		// Only the upload needs this thread; everything else was done on the loader's
+		if (!are_assets_loaded && pollAssetLoader(&asset_loader)) {
+			TRACE_SPAN("upload texture atlas")
+				texture_atlas = uploadLoadedTextureAtlas(&asset_loader);
+			title_screen_draw_data.texture_atlas = texture_atlas;
+			gameplay_draw_data.texture_atlas = texture_atlas;
+			sprite_batch.texture = texture_atlas;
+			bakeGameplayBackground(&gameplay_draw_data);
+
+			// Mixed and fed to the device on a thread of its own from here on
+			if (!startAudioThread(&audio, takeLoadedMusic(&asset_loader)))
+				fprintf(stderr, "citadel: can't start the audio thread\n");
+
+			recordTraceSpan("load assets", asset_loader.start_seconds, asset_loader.done_seconds);
+			fprintf(stderr, "citadel: assets ready after %.1f ms\n", (getTraceSeconds() - startup_start_seconds) * 1e3);
+			are_assets_loaded = true;
+		}
+
+		if (IsKeyPressed(KEY_F3))
+			toggleProfiler(&profiler);
+
+		if (IsWindowResized())
+			bakeGameplayBackground(&gameplay_draw_data);
+
 		BeginDrawing(); // OK to have updation code after this
 
 		switch (meta_state) {
@@ -1351,23 +1048,114 @@ respawn:
 			drawTitleScreen(&title_screen_draw_data);
 			break;
 		case GAME:
-			updateGameUiLogic(&game_ui_logic, &gameplay_logic, &gameplay_physics, &gameplay_draw_data);
-			updateGameplayLogic(&gameplay_logic, &gameplay_physics, &gameplay_draw_data);
-			updateGameplayPhysics(&gameplay_physics);
-
-			updateGameplayDrawData(&gameplay_draw_data, &gameplay_physics);
-printf("num_outposts: %u\n", gameplay_draw_data.outposts_count); // TODO outposts, tanks randomly disappear
-			drawGameplay(&gameplay_logic, &gameplay_physics, &gameplay_draw_data);
-			drawGameUi(&game_ui_logic, &gameplay_logic, &gameplay_draw_data, texture_atlas);
+			PROFILE_PHASE(&profiler, PROFILER_PHASE_UI_LOGIC)
+				updateGameUiLogic(&game_ui_logic);
+
+			// Loading would throw off a recording or a replay, so only free play may
+			if (IsKeyPressed(KEY_F5) && !saveGameplaySnapshot(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, QUICKSAVE_SNAPSHOT_PATH))
+				fprintf(stderr, "citadel: can't save %s\n", QUICKSAVE_SNAPSHOT_PATH);
+			if (IsKeyPressed(KEY_F9) && record_path == NULL && replay_path == NULL) {
+				if (loadGameplaySnapshot(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, QUICKSAVE_SNAPSHOT_PATH)) {
+					gameplay_seconds_accumulated = 0.f;
+					game_ui_logic.pending_commands_count = 0;
+				} else {
+					fprintf(stderr, "citadel: can't load %s\n", QUICKSAVE_SNAPSHOT_PATH);
+				}
+			}
+
+			// Grow storage for a whole wave here rather than mid-tick
+			reserveGameplay(&gameplay_logic, &gameplay_physics, gameplay_logic.tanks_count + getPendingSpawnsCount(&gameplay_logic), gameplay_logic.outposts_count + 1);
+			gameplay_seconds_accumulated += GetFrameTime();
+			for (
+				uint8_t ticks_count = 0;
+				gameplay_seconds_accumulated >= SIMULATION_TICK_SECONDS && ticks_count < MAXIMUM_SIMULATION_TICKS_PER_FRAME;
+				ticks_count++
+			) {
+				if (replay_path != NULL) {
+					applyReplayCommands(&replay_log, &replay_next_command_index, &gameplay_logic, &gameplay_physics, &gameplay_draw_data);
+				} else {
+					for (uint8_t i = 0; i < game_ui_logic.pending_commands_count; i++) {
+						game_ui_logic.pending_commands[i].tick = gameplay_logic.ticks_count;
+						if (applyGameplayCommand(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, game_ui_logic.pending_commands[i]) && record_path != NULL)
+							recordReplayCommand(&replay_log, game_ui_logic.pending_commands[i]);
+					}
+					game_ui_logic.pending_commands_count = 0;
+				}
+
+				PROFILE_PHASE(&profiler, PROFILER_PHASE_GAMEPLAY_LOGIC)
+					updateGameplayLogic(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, SIMULATION_TICK_SECONDS);
+				PROFILE_PHASE(&profiler, PROFILER_PHASE_GAMEPLAY_PHYSICS)
+					updateGameplayPhysics(&gameplay_physics, SIMULATION_TICK_SECONDS);
+				gameplay_seconds_accumulated -= SIMULATION_TICK_SECONDS;
+
+				// Checksums only cost anything while recording or replaying
+				uint32_t tick = gameplay_logic.ticks_count - 1;
+				if (record_path != NULL) {
+					recordReplayChecksum(&replay_log, getGameplayChecksum(&gameplay_logic, &gameplay_physics));
+				} else if (replay_path != NULL && tick < replay_log.checksums_count && getGameplayChecksum(&gameplay_logic, &gameplay_physics) != replay_log.checksums[tick]) {
+					if (replay_mismatches_count++ == 0)
+						fprintf(stderr, "citadel: replay diverged at tick %u\n", tick);
+				}
+			}
+			if (replay_path != NULL && gameplay_logic.ticks_count >= replay_log.checksums_count) {
+				fprintf(stderr, "citadel: replayed %u ticks, %u mismatched\n", replay_log.checksums_count, replay_mismatches_count);
+				goto quit;
+			}
+			if (gameplay_seconds_accumulated >= SIMULATION_TICK_SECONDS) // Drop ticks the catch-up cap couldn't cover
+				gameplay_seconds_accumulated = fmodf(gameplay_seconds_accumulated, SIMULATION_TICK_SECONDS);
+
+			PROFILE_PHASE(&profiler, PROFILER_PHASE_GAMEPLAY_DRAW_DATA)
+				updateGameplayDrawData(&gameplay_draw_data, &gameplay_logic, &gameplay_physics, GetFrameTime(), gameplay_seconds_accumulated / SIMULATION_TICK_SECONDS);
+			if (game_ui_logic.is_ui_active)
+				refreshPlacementOverlay(&gameplay_draw_data, &gameplay_logic.placement_map);
+
+			PROFILE_PHASE(&profiler, PROFILER_PHASE_DRAW_GAMEPLAY)
+				drawGameplay(&gameplay_logic, &gameplay_physics, &gameplay_draw_data, &sprite_batch, &trail_mesh);
+			PROFILE_PHASE(&profiler, PROFILER_PHASE_DRAW_GAME_UI)
+				drawGameUi(&game_ui_logic, &gameplay_logic, &gameplay_draw_data, texture_atlas);
+
+			if (profiler.is_enabled) {
+				AudioStats audio_stats = getAudioStats(&audio);
+				drawProfilerOverlay(&profiler, (Vector2) {10, 10}, TextFormat(
+					"tanks: %u, outposts: %u, shots: %u (%llu dropped)\nsprites: %u in %u draw calls, trail triangles: %u in %u\naudio: %u/%u frames buffered, %u underruns (%llu frames)",
+					gameplay_logic.tanks_count,
+					gameplay_logic.outposts_count,
+					gameplay_draw_data.outpost_shot_animations.count + gameplay_draw_data.tank_shot_animations.count,
+					(unsigned long long) (gameplay_draw_data.outpost_shot_animations.dropped_count + gameplay_draw_data.tank_shot_animations.dropped_count),
+					sprite_batch.last_flush_stats.sprites_count,
+					sprite_batch.last_flush_stats.draw_calls_count,
+					trail_mesh.last_flush_stats.triangles_count,
+					trail_mesh.last_flush_stats.draw_calls_count,
+					audio_stats.filled_frames_count,
+					audio_stats.capacity_frames_count,
+					audio_stats.underruns_count,
+					(unsigned long long) audio_stats.underrun_frames_count
+				));
+			}
 			break;
 		case QUIT:
 			goto quit;
 		}
 
 		EndDrawing();
+		endProfilerFrame(&profiler, GetFrameTime());
+
+		if (!is_first_frame_drawn) {
+			endTraceSpan("time to first frame", startup_start_seconds);
+			fprintf(stderr, "citadel: first frame after %.1f ms\n", (getTraceSeconds() - startup_start_seconds) * 1e3);
+			is_first_frame_drawn = true;
+		}
+		endTraceSpan("frame", frame_start_seconds);
 	}
 quit:
-	UnloadMusicStream(background_music);
+	if (trace_path != NULL)
+		stopTracing(trace_path);
+	if (record_path != NULL && !saveReplayLog(&replay_log, record_path))
+		fprintf(stderr, "citadel: can't save the replay to %s\n", record_path);
+	freeReplayLog(&replay_log);
+
+	stopAudioThread(&audio); // Owns the music now; before the device goes
+	stopAssetLoader(&asset_loader);
 	CloseAudioDevice();
 	CloseWindow();
 	return 0;
@@ -0,0 +1,47 @@
+#include <stdlib.h>
+
+#include "entity_pool.h" // allocateAligned()
+#include "particle_ring.h"
+
+void initParticleRing(ParticleRing *ring, uint32_t capacity, size_t particle_size, float lifetime_seconds, ParticleRingOverflowPolicy overflow_policy)
+{
+	uint32_t rounded_capacity = 1;
+	while (rounded_capacity < capacity)
+		rounded_capacity *= 2;
+
+	*ring = (ParticleRing) {
+		.particles = allocateAligned(rounded_capacity * particle_size),
+		.births_seconds = allocateAligned(rounded_capacity * sizeof (double)),
+		.particle_size = particle_size,
+		.capacity = rounded_capacity,
+		.lifetime_seconds = lifetime_seconds,
+		.overflow_policy = overflow_policy,
+	};
+}
+
+void *emitParticle(ParticleRing *ring, double birth_seconds)
+{
+	if (ring->count == ring->capacity) {
+		ring->dropped_count++;
+		if (ring->overflow_policy == PARTICLE_RING_DROP_NEWEST)
+			return NULL;
+
+		ring->first++;
+		ring->count--;
+	}
+
+	uint32_t slot = (ring->first + ring->count) & (ring->capacity - 1);
+	ring->births_seconds[slot] = birth_seconds;
+	ring->count++;
+	ring->emitted_count++;
+	return (char *) ring->particles + slot * ring->particle_size;
+}
+
+void expireParticles(ParticleRing *ring, double now_seconds)
+{
+	double expired_births_seconds = now_seconds - ring->lifetime_seconds;
+	while (ring->count > 0 && ring->births_seconds[ring->first & (ring->capacity - 1)] <= expired_births_seconds) {
+		ring->first++;
+		ring->count--;
+	}
+}
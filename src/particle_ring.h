@@ -0,0 +1,50 @@
+#ifndef PARTICLE_RING_H
+#define PARTICLE_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+	PARTICLE_RING_DROP_NEWEST, // A full ring turns new particles away
+	PARTICLE_RING_DROP_OLDEST, // A full ring overwrites its oldest particle
+} ParticleRingOverflowPolicy;
+
+// Fixed-capacity FIFO of short-lived effects; never allocates after init.
+// Particles are emitted in birth order and all expire lifetime_seconds after
+// birth, so the expired ones are always a prefix: expiry only ever looks at
+// the front, and nothing is decremented per particle per frame. Particles
+// that want a shorter life than the ring's just stop drawing early.
+typedef struct {
+	void *particles; // capacity * particle_size bytes
+	double *births_seconds;
+	size_t particle_size;
+	uint32_t capacity; // Power of two, so wrapping is a mask
+	uint32_t first; // Unwrapped position of the oldest particle
+	uint32_t count;
+	float lifetime_seconds;
+	ParticleRingOverflowPolicy overflow_policy;
+	uint64_t emitted_count;
+	uint64_t dropped_count; // Turned away or overwritten before expiring
+} ParticleRing;
+
+// Rounds capacity up to a power of two
+void initParticleRing(ParticleRing *ring, uint32_t capacity, size_t particle_size, float lifetime_seconds, ParticleRingOverflowPolicy overflow_policy);
+
+// O(1); returns storage for the new particle to be filled in, or NULL if the policy dropped it
+void *emitParticle(ParticleRing *ring, double birth_seconds);
+
+// Drops every particle born lifetime_seconds or more before now_seconds
+void expireParticles(ParticleRing *ring, double now_seconds);
+
+// k counts from the oldest live particle
+static inline void *getParticle(ParticleRing const *ring, uint32_t k)
+{
+	return (char *) ring->particles + ((ring->first + k) & (ring->capacity - 1)) * ring->particle_size;
+}
+
+static inline float getParticleAge(ParticleRing const *ring, uint32_t k, double now_seconds)
+{
+	return now_seconds - ring->births_seconds[(ring->first + k) & (ring->capacity - 1)];
+}
+
+#endif
@@ -0,0 +1,47 @@
+#include <raymath.h>
+
+#include "path.h"
+
+void initPath(Path *path, Vector2 const *points, uint8_t points_count)
+{
+	// Repeated points would make zero-length segments with no direction, so
+	// those are merged away; no segments at all leaves a path of length 0
+	path->segments_count = 0;
+	path->starts[0] = points[0];
+	path->directions[0] = (Vector2) {};
+	path->cumulative_lengths[0] = 0.f;
+	for (uint8_t i = 0; i + 1 < points_count; i++) {
+		Vector2 difference = Vector2Subtract(points[i + 1], points[i]);
+		float segment_length = Vector2Length(difference);
+		if (segment_length == 0.f)
+			continue;
+
+		uint8_t segment_index = path->segments_count++;
+		path->starts[segment_index] = points[i];
+		path->directions[segment_index] = Vector2Scale(difference, 1.f / segment_length);
+		path->cumulative_lengths[segment_index + 1] = path->cumulative_lengths[segment_index] + segment_length;
+	}
+	path->length = path->cumulative_lengths[path->segments_count];
+}
+
+void evaluatePath(Path const *path, float const *progresses, float const *speeds, uint32_t count, float *positions_x, float *positions_y, float *velocities_x, float *velocities_y)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		float progress = Clamp(progresses[i], 0.f, path->length);
+
+		// Counting the segment starts already passed finds the segment
+		// without a data-dependent branch; paths are short enough that
+		// this beats a binary search
+		uint8_t segment_index = 0;
+		for (uint8_t k = 1; k < path->segments_count; k++)
+			segment_index += progress >= path->cumulative_lengths[k];
+
+		Vector2 direction = path->directions[segment_index];
+		float along = progress - path->cumulative_lengths[segment_index];
+
+		positions_x[i] = path->starts[segment_index].x + direction.x * along;
+		positions_y[i] = path->starts[segment_index].y + direction.y * along;
+		velocities_x[i] = direction.x * speeds[i];
+		velocities_y[i] = direction.y * speeds[i];
+	}
+}
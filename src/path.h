@@ -0,0 +1,28 @@
+#ifndef PATH_H
+#define PATH_H
+
+#include <stdint.h>
+
+#include <raylib.h>
+
+#define PATH_MAXIMUM_POINTS_COUNT UINT8_MAX
+
+// A polyline parameterised by arc length, so anything following it is just
+// a distance travelled: progress 0 is points[0] and progress length the
+// last point. Progress past either end is clamped to it.
+typedef struct {
+	Vector2 starts[PATH_MAXIMUM_POINTS_COUNT - 1]; // Where segment i begins
+	float cumulative_lengths[PATH_MAXIMUM_POINTS_COUNT]; // Arc length from the first point to where segment i begins
+	Vector2 directions[PATH_MAXIMUM_POINTS_COUNT - 1]; // Unit direction of segment i
+	float length;
+	uint8_t segments_count;
+} Path;
+
+// Needs at least one point; repeats of the point before are skipped
+void initPath(Path *path, Vector2 const *points, uint8_t points_count);
+
+// Writes the position at each progress, and the velocity when moving along
+// the path at the matching speed
+void evaluatePath(Path const *path, float const *progresses, float const *speeds, uint32_t count, float *positions_x, float *positions_y, float *velocities_x, float *velocities_y);
+
+#endif
@@ -0,0 +1,81 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "pcm_ring.h"
+
+bool initPcmRing(PcmRing *ring, uint32_t capacity, uint8_t channels_count)
+{
+	uint32_t rounded_capacity = 1;
+	while (rounded_capacity < capacity)
+		rounded_capacity *= 2;
+
+	*ring = (PcmRing) {
+		.samples = calloc((size_t) rounded_capacity * channels_count, sizeof (int16_t)),
+		.capacity = rounded_capacity,
+		.channels_count = channels_count,
+	};
+	return ring->samples != NULL;
+}
+
+void freePcmRing(PcmRing *ring)
+{
+	free(ring->samples);
+	ring->samples = NULL;
+}
+
+uint32_t getPcmRingFilledFrames(PcmRing const *ring)
+{
+	// Read first, so a concurrent read can only make this overestimate by what was just consumed
+	uint64_t read_frames_count = atomic_load_explicit(&ring->read_frames_count, memory_order_acquire);
+	return atomic_load_explicit(&ring->written_frames_count, memory_order_acquire) - read_frames_count;
+}
+
+// A run of frames_count frames from unwrapped position on wraps at most
+// once; this is how many come before the wrap
+static uint32_t getPcmRingFirstRunFramesCount(PcmRing const *ring, uint64_t position, uint32_t frames_count)
+{
+	uint32_t frames_till_wrap_count = ring->capacity - (position & (ring->capacity - 1));
+	return frames_till_wrap_count < frames_count ? frames_till_wrap_count : frames_count;
+}
+
+uint32_t writePcmRing(PcmRing *ring, int16_t const *frames, uint32_t frames_count)
+{
+	uint64_t written_frames_count = atomic_load_explicit(&ring->written_frames_count, memory_order_relaxed); // Our own
+	uint64_t read_frames_count = atomic_load_explicit(&ring->read_frames_count, memory_order_acquire);
+
+	uint32_t free_frames_count = ring->capacity - (uint32_t) (written_frames_count - read_frames_count);
+	if (frames_count > free_frames_count)
+		frames_count = free_frames_count;
+
+	uint32_t first_run_frames_count = getPcmRingFirstRunFramesCount(ring, written_frames_count, frames_count);
+	size_t frame_size = ring->channels_count * sizeof (int16_t);
+	memcpy(ring->samples + (written_frames_count & (ring->capacity - 1)) * ring->channels_count, frames, first_run_frames_count * frame_size);
+	memcpy(ring->samples, frames + (size_t) first_run_frames_count * ring->channels_count, (frames_count - first_run_frames_count) * frame_size);
+
+	// Publishes the frames: the consumer's acquire load sees them before the count
+	atomic_store_explicit(&ring->written_frames_count, written_frames_count + frames_count, memory_order_release);
+	return frames_count;
+}
+
+void readPcmRing(PcmRing *ring, int16_t *frames, uint32_t frames_count)
+{
+	uint64_t read_frames_count = atomic_load_explicit(&ring->read_frames_count, memory_order_relaxed); // Our own
+	uint64_t written_frames_count = atomic_load_explicit(&ring->written_frames_count, memory_order_acquire);
+
+	uint32_t available_frames_count = written_frames_count - read_frames_count;
+	uint32_t copied_frames_count = available_frames_count < frames_count ? available_frames_count : frames_count;
+
+	uint32_t first_run_frames_count = getPcmRingFirstRunFramesCount(ring, read_frames_count, copied_frames_count);
+	size_t frame_size = ring->channels_count * sizeof (int16_t);
+	memcpy(frames, ring->samples + (read_frames_count & (ring->capacity - 1)) * ring->channels_count, first_run_frames_count * frame_size);
+	memcpy(frames + (size_t) first_run_frames_count * ring->channels_count, ring->samples, (copied_frames_count - first_run_frames_count) * frame_size);
+
+	if (copied_frames_count < frames_count) {
+		memset(frames + (size_t) copied_frames_count * ring->channels_count, 0, (frames_count - copied_frames_count) * frame_size);
+		atomic_fetch_add_explicit(&ring->underrun_frames_count, frames_count - copied_frames_count, memory_order_relaxed);
+		atomic_fetch_add_explicit(&ring->underruns_count, 1, memory_order_relaxed);
+	}
+
+	// Hands the slots back: the producer's acquire load sees them read before reusing them
+	atomic_store_explicit(&ring->read_frames_count, read_frames_count + copied_frames_count, memory_order_release);
+}
@@ -0,0 +1,42 @@
+#ifndef PCM_RING_H
+#define PCM_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PCM_RING_ALIGNMENT 64 // Each side's index on its own cache line
+
+// Lock-free single-producer, single-consumer ring of interleaved 16-bit
+// frames. Each side only stores its own running count (release) and loads
+// the other's (acquire), so neither ever blocks the other; the counts never
+// wrap in practice and the capacity is a power of two, so full and empty
+// never look alike.
+typedef struct {
+	int16_t *samples; // capacity * channels_count
+	uint32_t capacity; // In frames
+	uint8_t channels_count;
+
+	_Alignas(PCM_RING_ALIGNMENT) _Atomic uint64_t written_frames_count; // Stored by the producer only
+	_Alignas(PCM_RING_ALIGNMENT) _Atomic uint64_t read_frames_count; // Stored by the consumer only
+
+	// Also the consumer's; anyone may load them
+	_Atomic uint64_t underrun_frames_count; // Frames it had to fill with silence
+	_Atomic uint32_t underruns_count; // Reads that came up short
+} PcmRing;
+
+// Rounds capacity up to a power of two; false if it can't allocate
+bool initPcmRing(PcmRing *ring, uint32_t capacity, uint8_t channels_count);
+void freePcmRing(PcmRing *ring);
+
+// Safe from either side or a third thread, though only a snapshot
+uint32_t getPcmRingFilledFrames(PcmRing const *ring);
+
+// Producer only: copies in as many of frames_count frames as fit and returns that many
+uint32_t writePcmRing(PcmRing *ring, int16_t const *frames, uint32_t frames_count);
+
+// Consumer only: always fills all frames_count frames, padding with silence
+// and counting an underrun if the producer has fallen behind
+void readPcmRing(PcmRing *ring, int16_t *frames, uint32_t frames_count);
+
+#endif
@@ -0,0 +1,91 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include <raymath.h>
+
+#include "placement_map.h"
+
+void initPlacementMap(PlacementMap *map, uint16_t width, uint16_t height)
+{
+	*map = (PlacementMap) {
+		.blockers_counts = calloc((size_t) width * height, sizeof (uint8_t)),
+		.width = width,
+		.height = height,
+	};
+}
+
+static bool isNearPathSegment(Vector2 position, Vector2 start, Vector2 end, float clearance)
+{
+	float cos = Vector2DotProduct(
+		Vector2Normalize(Vector2Subtract(position, start)),
+		Vector2Normalize(Vector2Subtract(end, start))
+	);
+	float length = Vector2Length(Vector2Subtract(position, start));
+
+	return (
+		cos > 0 &&
+		length * cos < Vector2Length(Vector2Subtract(end, start)) &&
+		length * sqrt(1 - cos * cos) < clearance
+	) || Vector2Distance(position, end) < clearance;
+}
+
+// Inclusive pixel range strictly inside (low, high), clamped to [0, count)
+static void getPixelRange(float low, float high, uint16_t count, int32_t *first, int32_t *last)
+{
+	*first = (int32_t) floorf(low) + 1;
+	*last = (int32_t) ceilf(high) - 1;
+	if (*first < 0)
+		*first = 0;
+	if (*last > count - 1)
+		*last = count - 1;
+}
+
+void blockPlacementNearPath(PlacementMap *map, Vector2 const *path_points, uint8_t path_points_count, float clearance)
+{
+	for (uint8_t i = 0; i + 1 < path_points_count; i++) {
+		// Only the segment's bounding box, grown by the clearance, can be near it
+		int32_t first_x, last_x, first_y, last_y;
+		getPixelRange(fminf(path_points[i].x, path_points[i + 1].x) - clearance, fmaxf(path_points[i].x, path_points[i + 1].x) + clearance, map->width, &first_x, &last_x);
+		getPixelRange(fminf(path_points[i].y, path_points[i + 1].y) - clearance, fmaxf(path_points[i].y, path_points[i + 1].y) + clearance, map->height, &first_y, &last_y);
+
+		for (int32_t y = first_y; y <= last_y; y++)
+			for (int32_t x = first_x; x <= last_x; x++)
+				if (isNearPathSegment((Vector2) {x, y}, path_points[i], path_points[i + 1], clearance))
+					map->blockers_counts[y * map->width + x] = 1; // The path counts once however many segments cover a pixel
+	}
+
+	map->revision++;
+}
+
+static void addToPlacementSquare(PlacementMap *map, Vector2 center, float reach, int8_t delta)
+{
+	int32_t first_x, last_x, first_y, last_y;
+	getPixelRange(center.x - reach, center.x + reach, map->width, &first_x, &last_x);
+	getPixelRange(center.y - reach, center.y + reach, map->height, &first_y, &last_y);
+
+	for (int32_t y = first_y; y <= last_y; y++)
+		for (int32_t x = first_x; x <= last_x; x++)
+			map->blockers_counts[y * map->width + x] += delta;
+
+	map->revision++;
+}
+
+void addPlacementBlocker(PlacementMap *map, Vector2 center, float reach)
+{
+	addToPlacementSquare(map, center, reach, 1);
+}
+
+void removePlacementBlocker(PlacementMap *map, Vector2 center, float reach)
+{
+	addToPlacementSquare(map, center, reach, -1);
+}
+
+bool isPlacementValid(PlacementMap const *map, Vector2 position)
+{
+	int32_t x = lroundf(position.x);
+	int32_t y = lroundf(position.y);
+	if (x < 0 || x >= map->width || y < 0 || y >= map->height)
+		return false;
+
+	return map->blockers_counts[y * map->width + x] == 0;
+}
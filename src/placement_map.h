@@ -0,0 +1,32 @@
+#ifndef PLACEMENT_MAP_H
+#define PLACEMENT_MAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <raylib.h>
+
+// Per-pixel count of what blocks placing something centred on that pixel:
+// the path, baked once, plus every placed square, added and removed
+// incrementally. A position is valid exactly when its count is zero.
+typedef struct {
+	uint8_t *blockers_counts; // Row-major, width * height
+	uint16_t width;
+	uint16_t height;
+	uint32_t revision; // Bumped on every change, so views know to refresh
+} PlacementMap;
+
+void initPlacementMap(PlacementMap *map, uint16_t width, uint16_t height);
+
+// Blocks every pixel whose perpendicular distance to a segment, or distance
+// to a segment's end point, is under clearance
+void blockPlacementNearPath(PlacementMap *map, Vector2 const *path_points, uint8_t path_points_count, float clearance);
+
+// Blocks or unblocks the pixels strictly closer than reach to center on both axes
+void addPlacementBlocker(PlacementMap *map, Vector2 center, float reach);
+void removePlacementBlocker(PlacementMap *map, Vector2 center, float reach);
+
+// Positions off the map are never valid
+bool isPlacementValid(PlacementMap const *map, Vector2 position);
+
+#endif
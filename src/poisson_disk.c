@@ -0,0 +1,143 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "poisson_disk.h"
+
+// Cells small enough that one can hold at most one point
+typedef struct {
+	float cell_size;
+	uint32_t columns_count;
+	uint32_t rows_count;
+} PoissonDiskGrid;
+
+static PoissonDiskGrid getPoissonDiskGrid(Rectangle area, float minimum_distance)
+{
+	float cell_size = minimum_distance / sqrtf(2.f);
+	uint32_t columns_count = ceilf(area.width / cell_size);
+	uint32_t rows_count = ceilf(area.height / cell_size);
+	return (PoissonDiskGrid) {
+		.cell_size = cell_size,
+		.columns_count = columns_count > 0 ? columns_count : 1,
+		.rows_count = rows_count > 0 ? rows_count : 1,
+	};
+}
+
+uint32_t getPoissonDiskCapacity(Rectangle area, float minimum_distance)
+{
+	PoissonDiskGrid grid = getPoissonDiskGrid(area, minimum_distance);
+	return grid.columns_count * grid.rows_count;
+}
+
+static uint32_t getPoissonDiskCell(PoissonDiskGrid const *grid, Rectangle area, Vector2 point)
+{
+	uint32_t column = (point.x - area.x) / grid->cell_size;
+	uint32_t row = (point.y - area.y) / grid->cell_size;
+	if (column >= grid->columns_count) // Float rounding at the far edges
+		column = grid->columns_count - 1;
+	if (row >= grid->rows_count)
+		row = grid->rows_count - 1;
+	return row * grid->columns_count + column;
+}
+
+static bool isPoissonDiskCandidateFree(PoissonDiskGrid const *grid, int32_t const *cells, Vector2 const *points, Rectangle area, float minimum_distance, Vector2 candidate)
+{
+	uint32_t cell = getPoissonDiskCell(grid, area, candidate);
+	int32_t column = cell % grid->columns_count;
+	int32_t row = cell / grid->columns_count;
+
+	// Anything within minimum_distance is at most two cells away
+	for (int32_t y = row - 2; y <= row + 2; y++) {
+		if (y < 0 || y >= (int32_t) grid->rows_count)
+			continue;
+		for (int32_t x = column - 2; x <= column + 2; x++) {
+			if (x < 0 || x >= (int32_t) grid->columns_count)
+				continue;
+
+			int32_t index = cells[y * grid->columns_count + x];
+			if (index < 0)
+				continue;
+
+			float dx = points[index].x - candidate.x;
+			float dy = points[index].y - candidate.y;
+			if (dx * dx + dy * dy < minimum_distance * minimum_distance)
+				return false;
+		}
+	}
+	return true;
+}
+
+uint32_t samplePoissonDisk(Vector2 *points, uint32_t points_capacity, Rectangle area, float minimum_distance, Prng *prng)
+{
+	if (points == NULL || points_capacity == 0 || area.width <= 0 || area.height <= 0 || minimum_distance <= 0)
+		return 0;
+
+	PoissonDiskGrid grid = getPoissonDiskGrid(area, minimum_distance);
+	uint32_t cells_count = grid.columns_count * grid.rows_count;
+	int32_t *cells = malloc(cells_count * sizeof (int32_t)); // Index into points, or -1
+	uint32_t *active_indices = malloc((points_capacity < cells_count ? points_capacity : cells_count) * sizeof (uint32_t));
+	if (cells == NULL || active_indices == NULL) {
+		free(cells);
+		free(active_indices);
+		return 0;
+	}
+	for (uint32_t i = 0; i < cells_count; i++)
+		cells[i] = -1;
+
+	points[0] = (Vector2) {
+		area.x + nextPrngFloat(prng) * area.width,
+		area.y + nextPrngFloat(prng) * area.height,
+	};
+	cells[getPoissonDiskCell(&grid, area, points[0])] = 0;
+	active_indices[0] = 0;
+	uint32_t points_count = 1;
+	uint32_t active_count = 1;
+
+	while (active_count > 0 && points_count < points_capacity) {
+		uint32_t active_index = nextPrngUint32(prng) % active_count;
+		Vector2 origin = points[active_indices[active_index]];
+
+		bool is_placed = false;
+		for (uint8_t attempt = 0; attempt < POISSON_DISK_ATTEMPTS_COUNT && !is_placed; attempt++) {
+			// Uniform over the annulus between one and two minimum distances out
+			float radius = minimum_distance * sqrtf(1.f + 3.f * nextPrngFloat(prng));
+			float angle = 2 * PI * nextPrngFloat(prng);
+			Vector2 candidate = {origin.x + radius * cosf(angle), origin.y + radius * sinf(angle)};
+
+			if (
+				candidate.x < area.x || candidate.x >= area.x + area.width ||
+				candidate.y < area.y || candidate.y >= area.y + area.height ||
+				!isPoissonDiskCandidateFree(&grid, cells, points, area, minimum_distance, candidate)
+			)
+				continue;
+
+			points[points_count] = candidate;
+			cells[getPoissonDiskCell(&grid, area, candidate)] = points_count;
+			active_indices[active_count++] = points_count;
+			points_count++;
+			is_placed = true;
+		}
+
+		if (!is_placed) // Retired: swap-remove, since the active order doesn't matter
+			active_indices[active_index] = active_indices[--active_count];
+	}
+
+	free(cells);
+	free(active_indices);
+	return points_count;
+}
+
+uint32_t pickPoissonDiskPoints(Vector2 *points, uint32_t points_count, uint32_t picks_count, Prng *prng)
+{
+	if (picks_count > points_count)
+		picks_count = points_count;
+
+	// The first picks_count steps of a Fisher-Yates shuffle
+	for (uint32_t i = 0; i < picks_count; i++) {
+		uint32_t j = i + nextPrngUint32(prng) % (points_count - i);
+		Vector2 point = points[i];
+		points[i] = points[j];
+		points[j] = point;
+	}
+	return picks_count;
+}
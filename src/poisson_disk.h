@@ -0,0 +1,33 @@
+#ifndef POISSON_DISK_H
+#define POISSON_DISK_H
+
+#include <stdint.h>
+
+#include <raylib.h>
+
+#include "prng.h"
+
+#define POISSON_DISK_ATTEMPTS_COUNT 30 // Bridson's k: candidates tried around a point before it's retired
+
+// Most points that can fit in area minimum_distance apart; a sample never
+// needs a bigger buffer than this
+uint32_t getPoissonDiskCapacity(Rectangle area, float minimum_distance);
+
+// Bridson's sampler: scatters points over area, none closer than
+// minimum_distance, until it's full or points_capacity are placed, and
+// returns how many were. Each candidate is only tested against the few
+// points in its cell neighbourhood of a background grid, and each point
+// is retired after at most POISSON_DISK_ATTEMPTS_COUNT misses, so it always
+// ends, after at most points_capacity * (POISSON_DISK_ATTEMPTS_COUNT + 1)
+// candidates.
+//
+// Points come out in growth order, outward from the first, so stopping at
+// points_capacity leaves a clump; to scatter fewer than fit, sample the
+// area full and pick from that with pickPoissonDiskPoints().
+uint32_t samplePoissonDisk(Vector2 *points, uint32_t points_capacity, Rectangle area, float minimum_distance, Prng *prng);
+
+// Moves a uniformly random picks_count of the points to the front, in
+// random order, and returns how many that is (fewer if there aren't enough)
+uint32_t pickPoissonDiskPoints(Vector2 *points, uint32_t points_count, uint32_t picks_count, Prng *prng);
+
+#endif
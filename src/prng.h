@@ -0,0 +1,32 @@
+#ifndef PRNG_H
+#define PRNG_H
+
+#include <stdint.h>
+
+// SplitMix64: one add and a few shifts and multiplies per number, and the
+// whole state is this one word, so it can live in (and be checksummed
+// with) the state it drives. Same seed, same sequence, on every platform.
+typedef struct {
+	uint64_t state;
+} Prng;
+
+static inline Prng seedPrng(uint64_t seed)
+{
+	return (Prng) {seed};
+}
+
+static inline uint32_t nextPrngUint32(Prng *prng)
+{
+	uint64_t z = (prng->state += 0x9e3779b97f4a7c15);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return (z ^ (z >> 31)) >> 32;
+}
+
+// Uniform in [0, 1)
+static inline float nextPrngFloat(Prng *prng)
+{
+	return (nextPrngUint32(prng) >> 8) * (1.f / (1 << 24));
+}
+
+#endif
@@ -0,0 +1,99 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "profiler.h"
+
+#define PROFILER_FONT_SIZE 20
+#define PROFILER_LINE_HEIGHT 24
+#define PROFILER_GRAPH_HEIGHT 100
+#define PROFILER_GRAPH_SECONDS (1.f / 30) // Full height of the graph
+
+char const *const profiler_phases_names[PROFILER_PHASES_COUNT] = {
+	[PROFILER_PHASE_UI_LOGIC] = "ui logic",
+	[PROFILER_PHASE_GAMEPLAY_LOGIC] = "gameplay logic",
+	[PROFILER_PHASE_GAMEPLAY_PHYSICS] = "gameplay physics",
+	[PROFILER_PHASE_GAMEPLAY_DRAW_DATA] = "gameplay draw data",
+	[PROFILER_PHASE_DRAW_GAMEPLAY] = "draw gameplay",
+	[PROFILER_PHASE_DRAW_GAME_UI] = "draw game ui",
+};
+
+void toggleProfiler(Profiler *profiler)
+{
+	profiler->is_enabled = !profiler->is_enabled;
+	profiler->next_frame_index = 0;
+	profiler->frames_count = 0;
+	memset(profiler->current_phases_seconds, 0, sizeof profiler->current_phases_seconds);
+}
+
+void endProfilerFrame(Profiler *profiler, float frame_seconds)
+{
+	if (!profiler->is_enabled)
+		return;
+
+	memcpy(profiler->phases_seconds[profiler->next_frame_index], profiler->current_phases_seconds, sizeof profiler->current_phases_seconds);
+	memset(profiler->current_phases_seconds, 0, sizeof profiler->current_phases_seconds);
+	profiler->frames_seconds[profiler->next_frame_index] = frame_seconds;
+
+	profiler->next_frame_index = (profiler->next_frame_index + 1) % PROFILER_FRAMES_COUNT;
+	if (profiler->frames_count < PROFILER_FRAMES_COUNT)
+		profiler->frames_count++;
+}
+
+static float getColumnX(uint8_t column)
+{
+	return column == 0 ? 0.f : 140.f + 80.f * column;
+}
+
+static int compareFloats(void const *a, void const *b)
+{
+	float x = *(float const *) a;
+	float y = *(float const *) b;
+	return (x > y) - (x < y);
+}
+
+void drawProfilerOverlay(Profiler const *profiler, Vector2 position, char const *counters_text)
+{
+	float y = position.y;
+
+	// raylib's default font isn't monospaced, so each column gets its own x
+	static char const *const columns_headers[4] = {"phase", "min ms", "avg ms", "p99 ms"};
+	for (uint8_t column = 0; column < 4; column++)
+		DrawText(columns_headers[column], position.x + getColumnX(column), y, PROFILER_FONT_SIZE, GRAY);
+	y += PROFILER_LINE_HEIGHT;
+
+	float samples[PROFILER_FRAMES_COUNT];
+	for (uint8_t phase = 0; phase < PROFILER_PHASES_COUNT; phase++) {
+		DrawText(profiler_phases_names[phase], position.x, y, PROFILER_FONT_SIZE, WHITE);
+
+		if (profiler->frames_count > 0) {
+			float total = 0.f;
+			for (uint32_t i = 0; i < profiler->frames_count; i++) {
+				samples[i] = profiler->phases_seconds[i][phase];
+				total += samples[i];
+			}
+			qsort(samples, profiler->frames_count, sizeof (float), compareFloats);
+
+			float const columns_seconds[3] = {samples[0], total / profiler->frames_count, samples[profiler->frames_count * 99 / 100]};
+			for (uint8_t column = 1; column < 4; column++)
+				DrawText(TextFormat("%.3f", columns_seconds[column - 1] * 1e3f), position.x + getColumnX(column), y, PROFILER_FONT_SIZE, WHITE);
+		}
+		y += PROFILER_LINE_HEIGHT;
+	}
+
+	// Oldest frame on the left; the line marks 60 FPS
+	y += PROFILER_LINE_HEIGHT / 2;
+	DrawRectangle(position.x, y, PROFILER_FRAMES_COUNT * 2, PROFILER_GRAPH_HEIGHT, (Color) {0, 0, 0, 127});
+	for (uint32_t k = 0; k < profiler->frames_count; k++) {
+		uint32_t i = (profiler->next_frame_index + PROFILER_FRAMES_COUNT - profiler->frames_count + k) % PROFILER_FRAMES_COUNT;
+
+		float height = profiler->frames_seconds[i] / PROFILER_GRAPH_SECONDS * PROFILER_GRAPH_HEIGHT;
+		if (height > PROFILER_GRAPH_HEIGHT)
+			height = PROFILER_GRAPH_HEIGHT;
+		DrawRectangle(position.x + 2 * k, y + PROFILER_GRAPH_HEIGHT - height, 2, height, profiler->frames_seconds[i] > 1.f / 59 ? RED : GREEN);
+	}
+	DrawRectangle(position.x, y + PROFILER_GRAPH_HEIGHT / 2, PROFILER_FRAMES_COUNT * 2, 1, WHITE);
+	y += PROFILER_GRAPH_HEIGHT + PROFILER_LINE_HEIGHT / 2;
+
+	if (counters_text != NULL)
+		DrawText(counters_text, position.x, y, PROFILER_FONT_SIZE, WHITE);
+}
@@ -0,0 +1,74 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <raylib.h>
+
+#include "trace.h"
+
+typedef enum {
+	PROFILER_PHASE_UI_LOGIC,
+	PROFILER_PHASE_GAMEPLAY_LOGIC,
+	PROFILER_PHASE_GAMEPLAY_PHYSICS,
+	PROFILER_PHASE_GAMEPLAY_DRAW_DATA,
+	PROFILER_PHASE_DRAW_GAMEPLAY,
+	PROFILER_PHASE_DRAW_GAME_UI,
+	PROFILER_PHASES_COUNT,
+} ProfilerPhase;
+
+#define PROFILER_FRAMES_COUNT 240 // Rolling window; 4 seconds at 60 FPS
+
+extern char const *const profiler_phases_names[PROFILER_PHASES_COUNT];
+
+// Per-phase CPU time of the last PROFILER_FRAMES_COUNT frames. Phases are
+// also recorded as spans while tracing. With both off, timing a phase is a
+// predictable branch and nothing is stored.
+typedef struct {
+	float phases_seconds[PROFILER_FRAMES_COUNT][PROFILER_PHASES_COUNT]; // Ring, indexed by frame
+	float frames_seconds[PROFILER_FRAMES_COUNT];
+	float current_phases_seconds[PROFILER_PHASES_COUNT]; // Summed, as a phase may run several times a frame
+	double phases_start_seconds[PROFILER_PHASES_COUNT];
+	uint32_t next_frame_index;
+	uint32_t frames_count; // Up to PROFILER_FRAMES_COUNT
+	bool is_enabled;
+} Profiler;
+
+static inline void beginProfilerPhase(Profiler *profiler, ProfilerPhase phase)
+{
+	if (profiler->is_enabled || trace.is_enabled)
+		profiler->phases_start_seconds[phase] = getTraceSeconds();
+}
+
+static inline void endProfilerPhase(Profiler *profiler, ProfilerPhase phase)
+{
+	if (!profiler->is_enabled && !trace.is_enabled)
+		return;
+
+	double end_seconds = getTraceSeconds();
+	if (profiler->is_enabled)
+		profiler->current_phases_seconds[phase] += end_seconds - profiler->phases_start_seconds[phase];
+	recordTraceSpan(profiler_phases_names[phase], profiler->phases_start_seconds[phase], end_seconds);
+}
+
+// Times the statement or block that follows as phase, e.g.
+// PROFILE_PHASE(&profiler, PROFILER_PHASE_UI_LOGIC) updateGameUiLogic(&game_ui_logic);
+// Don't break out of it, or the phase never ends.
+#define PROFILE_PHASE(profiler, phase)\
+	for (\
+		bool profile_phase_pending = (beginProfilerPhase(profiler, phase), true);\
+		profile_phase_pending;\
+		profile_phase_pending = false, endProfilerPhase(profiler, phase)\
+	)
+
+// Starts from an empty window each time it's switched on
+void toggleProfiler(Profiler *profiler);
+
+// Files the phases timed since the last call as one frame
+void endProfilerFrame(Profiler *profiler, float frame_seconds);
+
+// Per-phase min/avg/p99 and a frame-time graph, with counters_text (may be NULL) underneath
+void drawProfilerOverlay(Profiler const *profiler, Vector2 position, char const *counters_text);
+
+#endif
@@ -0,0 +1,115 @@
+// Keep dx * dx + dy * dy rounded the same way in every kernel
+#pragma GCC optimize ("fp-contract=off")
+
+#include <stddef.h>
+
+#include "range_filter.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RANGE_FILTER_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// The SIMD kernels finish their tails here, hence first
+static uint32_t filterInRangeFrom(float const *positions_x, float const *positions_y, uint32_t const *ids, uint32_t first, uint32_t count, Vector2 center, float radius_squared, uint32_t *filtered_ids, uint32_t filtered_count)
+{
+	for (uint32_t i = first; i < count; i++) {
+		float dx = positions_x[i] - center.x;
+		float dy = positions_y[i] - center.y;
+
+		// Branch-free compaction: always write, only advance on a hit. The
+		// write never lands past i, so filtered_ids may alias ids.
+		filtered_ids[filtered_count] = ids != NULL ? ids[i] : i;
+		filtered_count += dx * dx + dy * dy < radius_squared;
+	}
+
+	return filtered_count;
+}
+
+static uint32_t filterInRangeScalar(float const *positions_x, float const *positions_y, uint32_t const *ids, uint32_t count, Vector2 center, float radius, uint32_t *filtered_ids)
+{
+	return filterInRangeFrom(positions_x, positions_y, ids, 0, count, center, radius * radius, filtered_ids, 0);
+}
+
+
+
+
+#ifdef RANGE_FILTER_X86_KERNELS
+
+// Appends the lanes set in mask, lowest first
+static inline uint32_t appendMaskedIds(uint32_t mask, uint32_t const *ids, uint32_t first, uint32_t *filtered_ids, uint32_t filtered_count)
+{
+	for (; mask != 0; mask &= mask - 1) {
+		uint32_t i = first + __builtin_ctz(mask);
+		filtered_ids[filtered_count++] = ids != NULL ? ids[i] : i;
+	}
+
+	return filtered_count;
+}
+
+__attribute__((target("sse2")))
+static uint32_t filterInRangeSse2(float const *positions_x, float const *positions_y, uint32_t const *ids, uint32_t count, Vector2 center, float radius, uint32_t *filtered_ids)
+{
+	__m128 const centers_x = _mm_set1_ps(center.x);
+	__m128 const centers_y = _mm_set1_ps(center.y);
+	__m128 const radii_squared = _mm_set1_ps(radius * radius);
+
+	uint32_t filtered_count = 0;
+	uint32_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(positions_x + i), centers_x);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(positions_y + i), centers_y);
+		__m128 distances_squared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+		filtered_count = appendMaskedIds(_mm_movemask_ps(_mm_cmplt_ps(distances_squared, radii_squared)), ids, i, filtered_ids, filtered_count);
+	}
+
+	return filterInRangeFrom(positions_x, positions_y, ids, i, count, center, radius * radius, filtered_ids, filtered_count);
+}
+
+__attribute__((target("avx2")))
+static uint32_t filterInRangeAvx2(float const *positions_x, float const *positions_y, uint32_t const *ids, uint32_t count, Vector2 center, float radius, uint32_t *filtered_ids)
+{
+	__m256 const centers_x = _mm256_set1_ps(center.x);
+	__m256 const centers_y = _mm256_set1_ps(center.y);
+	__m256 const radii_squared = _mm256_set1_ps(radius * radius);
+
+	uint32_t filtered_count = 0;
+	uint32_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(positions_x + i), centers_x);
+		__m256 dy = _mm256_sub_ps(_mm256_loadu_ps(positions_y + i), centers_y);
+		__m256 distances_squared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+		filtered_count = appendMaskedIds(_mm256_movemask_ps(_mm256_cmp_ps(distances_squared, radii_squared, _CMP_LT_OQ)), ids, i, filtered_ids, filtered_count);
+	}
+
+	return filterInRangeFrom(positions_x, positions_y, ids, i, count, center, radius * radius, filtered_ids, filtered_count);
+}
+
+#endif
+
+
+
+
+uint8_t getSupportedRangeFilterKernels(RangeFilterKernels kernels[RANGE_FILTER_KERNELS_MAXIMUM_COUNT])
+{
+	uint8_t kernels_count = 0;
+	kernels[kernels_count++] = (RangeFilterKernels) {"scalar", filterInRangeScalar};
+
+#ifdef RANGE_FILTER_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))
+		kernels[kernels_count++] = (RangeFilterKernels) {"sse2", filterInRangeSse2};
+	if (__builtin_cpu_supports("avx2"))
+		kernels[kernels_count++] = (RangeFilterKernels) {"avx2", filterInRangeAvx2};
+#endif
+
+	return kernels_count;
+}
+
+RangeFilterKernels selectRangeFilterKernels(void)
+{
+	RangeFilterKernels kernels[RANGE_FILTER_KERNELS_MAXIMUM_COUNT];
+	return kernels[getSupportedRangeFilterKernels(kernels) - 1];
+}
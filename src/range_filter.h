@@ -0,0 +1,29 @@
+#ifndef RANGE_FILTER_H
+#define RANGE_FILTER_H
+
+#include <stdint.h>
+
+#include <raylib.h>
+
+// Squared-distance range tests over struct-of-arrays positions: point i is
+// in range when dx * dx + dy * dy < radius * radius, with no sqrtf. Results
+// are compacted into an index list in ascending i order.
+
+// Writes ids[i] (or i when ids is NULL) for every point i in range of center
+// to filtered_ids, which may alias ids; returns how many were written
+typedef uint32_t (*FilterInRangeFunction)(float const *positions_x, float const *positions_y, uint32_t const *ids, uint32_t count, Vector2 center, float radius, uint32_t *filtered_ids);
+
+typedef struct {
+	char const *name;
+	FilterInRangeFunction filterInRange;
+} RangeFilterKernels;
+
+#define RANGE_FILTER_KERNELS_MAXIMUM_COUNT 3
+
+// Fills kernels with those the running CPU supports, narrowest first
+uint8_t getSupportedRangeFilterKernels(RangeFilterKernels kernels[RANGE_FILTER_KERNELS_MAXIMUM_COUNT]);
+
+// Widest supported kernels
+RangeFilterKernels selectRangeFilterKernels(void);
+
+#endif
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "replay.h"
+
+void initReplayLog(ReplayLog *log, uint64_t seed)
+{
+	*log = (ReplayLog) {
+		.seed = seed,
+	};
+}
+
+void freeReplayLog(ReplayLog *log)
+{
+	free(log->commands);
+	free(log->checksums);
+	initReplayLog(log, 0);
+}
+
+// Makes room for one more element past count
+static bool reserveArray(void **array, uint32_t *capacity, uint32_t count, size_t element_size)
+{
+	if (count < *capacity)
+		return true;
+
+	uint32_t new_capacity = *capacity > 0 ? *capacity * 2 : 1024;
+	void *new_array = realloc(*array, new_capacity * element_size);
+	if (new_array == NULL)
+		return false;
+
+	*array = new_array;
+	*capacity = new_capacity;
+	return true;
+}
+
+bool recordReplayCommand(ReplayLog *log, GameplayCommand command)
+{
+	if (!reserveArray((void **) &log->commands, &log->commands_capacity, log->commands_count, sizeof (GameplayCommand)))
+		return false;
+
+	log->commands[log->commands_count++] = command;
+	return true;
+}
+
+bool recordReplayChecksum(ReplayLog *log, uint32_t checksum)
+{
+	if (!reserveArray((void **) &log->checksums, &log->checksums_capacity, log->checksums_count, sizeof (uint32_t)))
+		return false;
+
+	log->checksums[log->checksums_count++] = checksum;
+	return true;
+}
+
+
+
+
+// Field by field rather than whole structs, so padding never reaches the
+// file; fixed-width little-endian, as on every platform we build for
+
+static bool writeField(FILE *file, void const *field, size_t size)
+{
+	return fwrite(field, size, 1, file) == 1;
+}
+
+static bool readField(FILE *file, void *field, size_t size)
+{
+	return fread(field, size, 1, file) == 1;
+}
+
+bool saveReplayLog(ReplayLog const *log, char const *path)
+{
+	FILE *file = fopen(path, "wb");
+	if (file == NULL)
+		return false;
+
+	uint32_t magic = REPLAY_MAGIC;
+	uint16_t version = REPLAY_VERSION;
+	uint16_t ticks_per_second = SIMULATION_TICKS_PER_SECOND;
+	bool is_written = (
+		writeField(file, &magic, sizeof magic) &&
+		writeField(file, &version, sizeof version) &&
+		writeField(file, &ticks_per_second, sizeof ticks_per_second) &&
+		writeField(file, &log->seed, sizeof log->seed) &&
+		writeField(file, &log->commands_count, sizeof log->commands_count) &&
+		writeField(file, &log->checksums_count, sizeof log->checksums_count)
+	);
+
+	for (uint32_t i = 0; is_written && i < log->commands_count; i++) {
+		GameplayCommand const *command = &log->commands[i];
+		is_written = (
+			writeField(file, &command->tick, sizeof command->tick) &&
+			writeField(file, &command->position.x, sizeof command->position.x) &&
+			writeField(file, &command->position.y, sizeof command->position.y) &&
+			writeField(file, &command->outpost_type, sizeof command->outpost_type)
+		);
+	}
+
+	if (is_written && log->checksums_count > 0)
+		is_written = fwrite(log->checksums, sizeof (uint32_t), log->checksums_count, file) == log->checksums_count;
+
+	return fclose(file) == 0 && is_written;
+}
+
+bool loadReplayLog(ReplayLog *log, char const *path)
+{
+	FILE *file = fopen(path, "rb");
+	if (file == NULL)
+		return false;
+
+	uint32_t magic;
+	uint16_t version;
+	uint16_t ticks_per_second;
+	uint64_t seed;
+	uint32_t commands_count;
+	uint32_t checksums_count;
+	bool is_read = (
+		readField(file, &magic, sizeof magic) &&
+		readField(file, &version, sizeof version) &&
+		readField(file, &ticks_per_second, sizeof ticks_per_second) &&
+		readField(file, &seed, sizeof seed) &&
+		readField(file, &commands_count, sizeof commands_count) &&
+		readField(file, &checksums_count, sizeof checksums_count) &&
+		magic == REPLAY_MAGIC &&
+		version == REPLAY_VERSION &&
+		ticks_per_second == SIMULATION_TICKS_PER_SECOND // Tick length changes every result
+	);
+
+	initReplayLog(log, is_read ? seed : 0);
+
+	for (uint32_t i = 0; is_read && i < commands_count; i++) {
+		GameplayCommand command;
+		is_read = (
+			readField(file, &command.tick, sizeof command.tick) &&
+			readField(file, &command.position.x, sizeof command.position.x) &&
+			readField(file, &command.position.y, sizeof command.position.y) &&
+			readField(file, &command.outpost_type, sizeof command.outpost_type) &&
+			recordReplayCommand(log, command)
+		);
+	}
+
+	for (uint32_t i = 0; is_read && i < checksums_count; i++) {
+		uint32_t checksum;
+		is_read = readField(file, &checksum, sizeof checksum) && recordReplayChecksum(log, checksum);
+	}
+
+	fclose(file);
+	if (!is_read)
+		freeReplayLog(log);
+	return is_read;
+}
+
+void applyReplayCommands(ReplayLog const *log, uint32_t *next_command_index, GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data)
+{
+	for (; *next_command_index < log->commands_count && log->commands[*next_command_index].tick <= gameplay_logic->ticks_count; (*next_command_index)++)
+		applyGameplayCommand(gameplay_logic, gameplay_physics, gameplay_draw_data, log->commands[*next_command_index]);
+}
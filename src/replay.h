@@ -0,0 +1,41 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gameplay.h"
+
+#define REPLAY_MAGIC 0x4c445443 // "CTDL", little-endian
+#define REPLAY_VERSION 2
+
+// A session as its seed, every command in tick order, and the checksum of
+// the state after every tick. On disk: a fixed header, then 13-byte
+// commands, then 4-byte checksums, all little-endian.
+typedef struct {
+	uint64_t seed;
+	GameplayCommand *commands;
+	uint32_t commands_count;
+	uint32_t commands_capacity;
+	uint32_t *checksums; // checksums[t] is getGameplayChecksum() once tick t has run
+	uint32_t checksums_count;
+	uint32_t checksums_capacity;
+} ReplayLog;
+
+void initReplayLog(ReplayLog *log, uint64_t seed);
+void freeReplayLog(ReplayLog *log);
+
+// Both grow the log as needed; false if that fails
+bool recordReplayCommand(ReplayLog *log, GameplayCommand command);
+bool recordReplayChecksum(ReplayLog *log, uint32_t checksum);
+
+bool saveReplayLog(ReplayLog const *log, char const *path);
+
+// Fails on I/O errors, a foreign file, or one recorded at another tick rate
+bool loadReplayLog(ReplayLog *log, char const *path);
+
+// Applies every logged command for the tick about to run, advancing
+// *next_command_index past them
+void applyReplayCommands(ReplayLog const *log, uint32_t *next_command_index, GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data);
+
+#endif
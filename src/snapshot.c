@@ -0,0 +1,355 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "snapshot.h"
+
+// Fixed-width fields throughout; the image is only ever read back by a
+// build with the same layouts, which the sizes below let it check
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t ticks_per_second;
+	uint32_t sections_count;
+	uint32_t reserved;
+	uint64_t file_size;
+} SnapshotHeader;
+
+typedef struct {
+	uint64_t offset;
+	uint64_t size;
+} SnapshotSection;
+
+typedef struct {
+	uint32_t count;
+	uint32_t slots_count;
+	uint32_t partitions_first_index[ENTITY_POOL_MAXIMUM_PARTITIONS_COUNT + 1];
+	uint32_t arrays_element_sizes[ENTITY_POOL_MAXIMUM_ARRAYS_COUNT];
+	uint8_t partitions_count;
+	uint8_t arrays_count;
+} SnapshotPool;
+
+typedef struct {
+	uint64_t emitted_count;
+	uint64_t dropped_count;
+	uint32_t first;
+	uint32_t count;
+	uint32_t capacity;
+	uint32_t particle_size;
+} SnapshotRing;
+
+// The first section: every scalar, plus what sizes the array sections
+typedef struct {
+	uint64_t prng_state;
+	double seconds_elapsed;
+	SnapshotRing outpost_shot_animations;
+	SnapshotRing tank_shot_animations;
+	SnapshotPool outposts_pool;
+	SnapshotPool tanks_pool;
+	uint32_t ticks_count;
+	uint32_t spawn_queue_count;
+	uint32_t spawn_queue_next_index;
+	float seconds_till_next_wave;
+	float current_wave_seconds;
+	float tanks_path_length; // Stands in for the map, which isn't saved
+	uint16_t placement_map_width;
+	uint16_t placement_map_height;
+	uint8_t current_wave_number;
+	uint8_t is_wave_spawning;
+} SnapshotState;
+
+typedef struct {
+	void *data;
+	size_t size;
+} SnapshotBlock;
+
+// State, then per pool its three slot arrays and its entity arrays, the
+// spawn queue, the placement map, then per ring its particles and births
+#define SNAPSHOT_MAXIMUM_SECTIONS_COUNT (1 + 2 * (3 + ENTITY_POOL_MAXIMUM_ARRAYS_COUNT) + 1 + 1 + 2 * 2)
+
+
+
+
+static size_t alignSnapshotOffset(size_t offset)
+{
+	return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+}
+
+static uint32_t listPoolSections(EntityPool const *pool, SnapshotPool const *saved_pool, SnapshotBlock *blocks)
+{
+	uint32_t count = 0;
+	blocks[count++] = (SnapshotBlock) {pool->dense_slots, saved_pool->slots_count * sizeof (uint32_t)};
+	blocks[count++] = (SnapshotBlock) {pool->slot_dense_indices, saved_pool->slots_count * sizeof (uint32_t)};
+	blocks[count++] = (SnapshotBlock) {pool->slot_generations, saved_pool->slots_count * sizeof (uint32_t)};
+	for (uint8_t i = 0; i < pool->arrays_count; i++)
+		blocks[count++] = (SnapshotBlock) {*pool->arrays[i], (size_t) saved_pool->count * saved_pool->arrays_element_sizes[i]};
+	return count;
+}
+
+static uint32_t listRingSections(ParticleRing const *ring, SnapshotBlock *blocks)
+{
+	blocks[0] = (SnapshotBlock) {ring->particles, ring->capacity * ring->particle_size};
+	blocks[1] = (SnapshotBlock) {ring->births_seconds, ring->capacity * sizeof (double)};
+	return 2;
+}
+
+// Where each section lives in memory and how big state says it is. Saving
+// only reads through the pointers, restoring only writes through them.
+static uint32_t listSnapshotSections(GameplayLogic const *gameplay_logic, GameplayDrawData const *gameplay_draw_data, SnapshotState const *state, SnapshotBlock *blocks)
+{
+	uint32_t count = 0;
+	blocks[count++] = (SnapshotBlock) {(void *) state, sizeof (SnapshotState)};
+	count += listPoolSections(&gameplay_logic->outposts_pool, &state->outposts_pool, blocks + count);
+	count += listPoolSections(&gameplay_logic->tanks_pool, &state->tanks_pool, blocks + count);
+	blocks[count++] = (SnapshotBlock) {gameplay_logic->spawn_queue.spawns, state->spawn_queue_count * sizeof (Spawn)};
+	blocks[count++] = (SnapshotBlock) {
+		gameplay_logic->placement_map.blockers_counts,
+		(size_t) state->placement_map_width * state->placement_map_height,
+	};
+	count += listRingSections(&gameplay_draw_data->outpost_shot_animations, blocks + count);
+	count += listRingSections(&gameplay_draw_data->tank_shot_animations, blocks + count);
+	return count;
+}
+
+
+
+
+static void saveSnapshotPool(SnapshotPool *saved_pool, EntityPool const *pool)
+{
+	saved_pool->count = pool->count;
+	saved_pool->slots_count = pool->capacity;
+	memcpy(saved_pool->partitions_first_index, pool->partitions_first_index, sizeof pool->partitions_first_index);
+	for (uint8_t i = 0; i < pool->arrays_count; i++)
+		saved_pool->arrays_element_sizes[i] = pool->arrays_element_sizes[i];
+	saved_pool->partitions_count = pool->partitions_count;
+	saved_pool->arrays_count = pool->arrays_count;
+}
+
+static void saveSnapshotRing(SnapshotRing *saved_ring, ParticleRing const *ring)
+{
+	saved_ring->emitted_count = ring->emitted_count;
+	saved_ring->dropped_count = ring->dropped_count;
+	saved_ring->first = ring->first;
+	saved_ring->count = ring->count;
+	saved_ring->capacity = ring->capacity;
+	saved_ring->particle_size = ring->particle_size;
+}
+
+bool saveGameplaySnapshot(GameplayLogic const *gameplay_logic, GameplayPhysics const *gameplay_physics, GameplayDrawData const *gameplay_draw_data, char const *path)
+{
+	(void) gameplay_physics; // Its per-tank arrays belong to the tanks pool, and its grid is rebuilt every tick
+
+	// Zeroed, padding included, so equal states always give equal files
+	SnapshotState state;
+	memset(&state, 0, sizeof state);
+	state.prng_state = gameplay_logic->prng.state;
+	state.seconds_elapsed = gameplay_draw_data->seconds_elapsed;
+	saveSnapshotRing(&state.outpost_shot_animations, &gameplay_draw_data->outpost_shot_animations);
+	saveSnapshotRing(&state.tank_shot_animations, &gameplay_draw_data->tank_shot_animations);
+	saveSnapshotPool(&state.outposts_pool, &gameplay_logic->outposts_pool);
+	saveSnapshotPool(&state.tanks_pool, &gameplay_logic->tanks_pool);
+	state.ticks_count = gameplay_logic->ticks_count;
+	state.spawn_queue_count = gameplay_logic->spawn_queue.count;
+	state.spawn_queue_next_index = gameplay_logic->spawn_queue.next_index;
+	state.seconds_till_next_wave = gameplay_logic->seconds_till_next_wave;
+	state.current_wave_seconds = gameplay_logic->current_wave_seconds;
+	state.tanks_path_length = gameplay_logic->tanks_path.length;
+	state.placement_map_width = gameplay_logic->placement_map.width;
+	state.placement_map_height = gameplay_logic->placement_map.height;
+	state.current_wave_number = gameplay_logic->current_wave_number;
+	state.is_wave_spawning = gameplay_logic->is_wave_spawning;
+
+	SnapshotBlock blocks[SNAPSHOT_MAXIMUM_SECTIONS_COUNT];
+	uint32_t sections_count = listSnapshotSections(gameplay_logic, gameplay_draw_data, &state, blocks);
+
+	SnapshotSection sections[SNAPSHOT_MAXIMUM_SECTIONS_COUNT];
+	size_t offset = alignSnapshotOffset(sizeof (SnapshotHeader) + sections_count * sizeof (SnapshotSection));
+	for (uint32_t i = 0; i < sections_count; i++) {
+		sections[i] = (SnapshotSection) {offset, blocks[i].size};
+		offset = alignSnapshotOffset(offset + blocks[i].size);
+	}
+
+	SnapshotHeader header = {
+		.magic = SNAPSHOT_MAGIC,
+		.version = SNAPSHOT_VERSION,
+		.ticks_per_second = SIMULATION_TICKS_PER_SECOND,
+		.sections_count = sections_count,
+		.file_size = offset,
+	};
+
+	// Assembled in memory first, so the file gets one write and no seeks
+	uint8_t *image = calloc(1, header.file_size);
+	if (image == NULL)
+		return false;
+
+	memcpy(image, &header, sizeof header);
+	memcpy(image + sizeof header, sections, sections_count * sizeof (SnapshotSection));
+	for (uint32_t i = 0; i < sections_count; i++)
+		if (blocks[i].size > 0)
+			memcpy(image + sections[i].offset, blocks[i].data, blocks[i].size);
+
+	int file = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	bool is_written = file >= 0;
+	for (size_t written_size = 0; is_written && written_size < header.file_size;) { // Only loops if write() comes up short
+		ssize_t result = write(file, image + written_size, header.file_size - written_size);
+		is_written = result > 0;
+		written_size += is_written ? result : 0;
+	}
+	if (file >= 0 && close(file) != 0)
+		is_written = false;
+
+	free(image);
+	return is_written;
+}
+
+
+
+
+static bool isSnapshotPoolCompatible(SnapshotPool const *saved_pool, EntityPool const *pool)
+{
+	if (
+		saved_pool->partitions_count != pool->partitions_count ||
+		saved_pool->arrays_count != pool->arrays_count ||
+		saved_pool->count > saved_pool->slots_count ||
+		saved_pool->partitions_first_index[0] != 0 ||
+		saved_pool->partitions_first_index[saved_pool->partitions_count] != saved_pool->count
+	)
+		return false;
+
+	for (uint8_t i = 0; i < saved_pool->partitions_count; i++)
+		if (saved_pool->partitions_first_index[i] > saved_pool->partitions_first_index[i + 1])
+			return false;
+
+	for (uint8_t i = 0; i < saved_pool->arrays_count; i++)
+		if (saved_pool->arrays_element_sizes[i] != pool->arrays_element_sizes[i])
+			return false;
+
+	return true;
+}
+
+static bool isSnapshotRingCompatible(SnapshotRing const *saved_ring, ParticleRing const *ring)
+{
+	return saved_ring->capacity == ring->capacity && saved_ring->particle_size == ring->particle_size && saved_ring->count <= saved_ring->capacity;
+}
+
+// Only the shape is checked; the contents of a file that passes are trusted
+static bool isSnapshotStateCompatible(SnapshotState const *state, GameplayLogic const *gameplay_logic, GameplayDrawData const *gameplay_draw_data)
+{
+	return (
+		isSnapshotPoolCompatible(&state->outposts_pool, &gameplay_logic->outposts_pool) &&
+		isSnapshotPoolCompatible(&state->tanks_pool, &gameplay_logic->tanks_pool) &&
+		isSnapshotRingCompatible(&state->outpost_shot_animations, &gameplay_draw_data->outpost_shot_animations) &&
+		isSnapshotRingCompatible(&state->tank_shot_animations, &gameplay_draw_data->tank_shot_animations) &&
+		state->placement_map_width == gameplay_logic->placement_map.width &&
+		state->placement_map_height == gameplay_logic->placement_map.height &&
+		state->tanks_path_length == gameplay_logic->tanks_path.length &&
+		state->spawn_queue_next_index <= state->spawn_queue_count
+	);
+}
+
+static void restoreSnapshotPool(EntityPool *pool, SnapshotPool const *saved_pool)
+{
+	restoreEntityPool(pool, saved_pool->count, saved_pool->slots_count);
+	memcpy(pool->partitions_first_index, saved_pool->partitions_first_index, sizeof pool->partitions_first_index);
+}
+
+static void restoreSnapshotRing(ParticleRing *ring, SnapshotRing const *saved_ring)
+{
+	ring->emitted_count = saved_ring->emitted_count;
+	ring->dropped_count = saved_ring->dropped_count;
+	ring->first = saved_ring->first;
+	ring->count = saved_ring->count;
+}
+
+static bool restoreSnapshotImage(uint8_t const *image, size_t image_size, GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data)
+{
+	SnapshotHeader const *header = (SnapshotHeader const *) image;
+	if (
+		header->magic != SNAPSHOT_MAGIC ||
+		header->version != SNAPSHOT_VERSION ||
+		header->ticks_per_second != SIMULATION_TICKS_PER_SECOND || // Tick length changes every result
+		header->file_size != image_size ||
+		header->sections_count == 0 ||
+		header->sections_count > SNAPSHOT_MAXIMUM_SECTIONS_COUNT ||
+		sizeof (SnapshotHeader) + header->sections_count * sizeof (SnapshotSection) > image_size
+	)
+		return false;
+
+	SnapshotSection const *sections = (SnapshotSection const *) (header + 1);
+	for (uint32_t i = 0; i < header->sections_count; i++)
+		if (sections[i].offset % SNAPSHOT_ALIGNMENT != 0 || sections[i].offset > image_size || sections[i].size > image_size - sections[i].offset)
+			return false;
+
+	if (sections[0].size != sizeof (SnapshotState))
+		return false;
+	SnapshotState const *state = (SnapshotState const *) (image + sections[0].offset);
+	if (!isSnapshotStateCompatible(state, gameplay_logic, gameplay_draw_data))
+		return false;
+
+	SnapshotBlock blocks[SNAPSHOT_MAXIMUM_SECTIONS_COUNT];
+	if (listSnapshotSections(gameplay_logic, gameplay_draw_data, state, blocks) != header->sections_count)
+		return false;
+	for (uint32_t i = 0; i < header->sections_count; i++)
+		if (blocks[i].size != sections[i].size)
+			return false;
+
+	// Growing is the one step that can fail, so it goes before any change;
+	// it moves the arrays, so list them again after
+	if (
+		!reserveEntityPool(&gameplay_logic->outposts_pool, state->outposts_pool.slots_count) ||
+		!reserveEntityPool(&gameplay_logic->tanks_pool, state->tanks_pool.slots_count) ||
+		!reserveSpawnQueue(&gameplay_logic->spawn_queue, state->spawn_queue_count)
+	)
+		return false;
+	listSnapshotSections(gameplay_logic, gameplay_draw_data, state, blocks);
+
+	for (uint32_t i = 1; i < header->sections_count; i++) // The state section is applied field by field below
+		if (blocks[i].size > 0)
+			memcpy(blocks[i].data, image + sections[i].offset, blocks[i].size);
+
+	gameplay_logic->prng.state = state->prng_state;
+	gameplay_logic->ticks_count = state->ticks_count;
+	gameplay_logic->spawn_queue.count = state->spawn_queue_count;
+	gameplay_logic->spawn_queue.next_index = state->spawn_queue_next_index;
+	gameplay_logic->seconds_till_next_wave = state->seconds_till_next_wave;
+	gameplay_logic->current_wave_seconds = state->current_wave_seconds;
+	gameplay_logic->current_wave_number = state->current_wave_number;
+	gameplay_logic->is_wave_spawning = state->is_wave_spawning;
+	gameplay_logic->placement_map.revision++; // Views of the map have to refresh
+
+	restoreSnapshotPool(&gameplay_logic->outposts_pool, &state->outposts_pool);
+	restoreSnapshotPool(&gameplay_logic->tanks_pool, &state->tanks_pool);
+	gameplay_logic->outposts_count = gameplay_physics->outposts_count = gameplay_draw_data->outposts_count = state->outposts_pool.count;
+	gameplay_logic->tanks_count = gameplay_physics->tanks_count = gameplay_draw_data->tanks_count = state->tanks_pool.count;
+
+	restoreSnapshotRing(&gameplay_draw_data->outpost_shot_animations, &state->outpost_shot_animations);
+	restoreSnapshotRing(&gameplay_draw_data->tank_shot_animations, &state->tank_shot_animations);
+	gameplay_draw_data->seconds_elapsed = state->seconds_elapsed;
+
+	return true;
+}
+
+bool loadGameplaySnapshot(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data, char const *path)
+{
+	int file = open(path, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	// Mapped rather than read, so the sections are copied straight out of the page cache
+	struct stat status;
+	void *image = MAP_FAILED;
+	if (fstat(file, &status) == 0 && (size_t) status.st_size >= sizeof (SnapshotHeader))
+		image = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file); // The mapping outlives the descriptor
+	if (image == MAP_FAILED)
+		return false;
+
+	bool is_restored = restoreSnapshotImage(image, status.st_size, gameplay_logic, gameplay_physics, gameplay_draw_data);
+	munmap(image, status.st_size);
+	return is_restored;
+}
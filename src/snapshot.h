@@ -0,0 +1,29 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+
+#include "gameplay.h"
+
+#define SNAPSHOT_MAGIC 0x534c4443 // "CDLS", little-endian
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_ALIGNMENT 64 // Of every section, so mapped arrays are as aligned as the pools' own
+
+// Everything the simulation carries between ticks, as one image of the
+// in-memory arrays: a header, a table of (offset, size) sections, then the
+// sections. Offsets are from the start of the file, so it holds no pointers
+// and maps anywhere. Restoring checks the header and sizes once, then
+// copies each section whole, however many entities there are.
+//
+// A snapshot only loads into a build with the same tick rate, map and
+// struct layouts, which the header and section sizes record.
+
+// Writes the image with a single write(); false on I/O errors
+bool saveGameplaySnapshot(GameplayLogic const *gameplay_logic, GameplayPhysics const *gameplay_physics, GameplayDrawData const *gameplay_draw_data, char const *path);
+
+// Restores into gameplay set up by initGameplay() on the same map, replacing
+// its state entirely. False, with the gameplay untouched, on I/O errors or a
+// foreign, truncated or incompatible file.
+bool loadGameplaySnapshot(GameplayLogic *gameplay_logic, GameplayPhysics *gameplay_physics, GameplayDrawData *gameplay_draw_data, char const *path);
+
+#endif
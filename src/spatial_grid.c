@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "spatial_grid.h"
+
+void initSpatialGrid(SpatialGrid *grid, float width, float height, float cell_size, uint32_t maximum_entities_count)
+{
+	*grid = (SpatialGrid) {
+		.inverse_cell_size = 1.f / cell_size,
+		.columns_count = width / cell_size + 1,
+		.rows_count = height / cell_size + 1,
+	};
+
+	grid->cells_first_index = malloc((grid->columns_count * grid->rows_count + 1) * sizeof (uint32_t));
+	reserveSpatialGrid(grid, maximum_entities_count);
+}
+
+bool reserveSpatialGrid(SpatialGrid *grid, uint32_t maximum_entities_count)
+{
+	if (maximum_entities_count <= grid->maximum_entities_count)
+		return true;
+
+	// Contents are rebuilt every tick, so nothing needs preserving, but the
+	// old buffers stay until all the new ones are in hand
+	uint32_t *sorted_indices = malloc(maximum_entities_count * sizeof (uint32_t));
+	float *sorted_positions_x = malloc(maximum_entities_count * sizeof (float));
+	float *sorted_positions_y = malloc(maximum_entities_count * sizeof (float));
+	uint32_t *entity_cells = malloc(maximum_entities_count * sizeof (uint32_t));
+	if (sorted_indices == NULL || sorted_positions_x == NULL || sorted_positions_y == NULL || entity_cells == NULL) {
+		free(sorted_indices);
+		free(sorted_positions_x);
+		free(sorted_positions_y);
+		free(entity_cells);
+		return false;
+	}
+
+	free(grid->sorted_indices);
+	free(grid->sorted_positions_x);
+	free(grid->sorted_positions_y);
+	free(grid->entity_cells);
+	grid->sorted_indices = sorted_indices;
+	grid->sorted_positions_x = sorted_positions_x;
+	grid->sorted_positions_y = sorted_positions_y;
+	grid->entity_cells = entity_cells;
+	grid->maximum_entities_count = maximum_entities_count;
+	return true;
+}
+
+bool reserveSpatialGridQuery(SpatialGridQuery *query, uint32_t capacity)
+{
+	if (capacity <= query->capacity)
+		return true;
+
+	// Filled anew by every query, so nothing needs preserving
+	free(query->indices);
+	free(query->positions_x);
+	free(query->positions_y);
+	query->indices = malloc(capacity * sizeof (uint32_t));
+	query->positions_x = malloc(capacity * sizeof (float));
+	query->positions_y = malloc(capacity * sizeof (float));
+	if (query->indices == NULL || query->positions_x == NULL || query->positions_y == NULL) {
+		free(query->indices);
+		free(query->positions_x);
+		free(query->positions_y);
+		*query = (SpatialGridQuery) {};
+		return false;
+	}
+
+	query->capacity = capacity;
+	return true;
+}
+
+static uint16_t getClampedCellCoordinate(float coordinate, float inverse_cell_size, uint16_t cells_count)
+{
+	float cell = coordinate * inverse_cell_size;
+	if (cell < 0.f)
+		return 0;
+	if (cell >= cells_count)
+		return cells_count - 1;
+	return cell;
+}
+
+bool rebuildSpatialGrid(SpatialGrid *grid, float const *positions_x, float const *positions_y, uint32_t entities_count)
+{
+	if (entities_count > grid->maximum_entities_count)
+		return false;
+
+	uint32_t cells_count = grid->columns_count * grid->rows_count;
+	memset(grid->cells_first_index, 0, (cells_count + 1) * sizeof (uint32_t));
+
+	for (uint32_t i = 0; i < entities_count; i++) {
+		uint32_t cell =
+			getClampedCellCoordinate(positions_y[i], grid->inverse_cell_size, grid->rows_count) * grid->columns_count +
+			getClampedCellCoordinate(positions_x[i], grid->inverse_cell_size, grid->columns_count);
+
+		grid->entity_cells[i] = cell;
+		grid->cells_first_index[cell + 1]++;
+	}
+
+	for (uint32_t i = 0; i < cells_count; i++)
+		grid->cells_first_index[i + 1] += grid->cells_first_index[i];
+
+	// Scatter, using cells_first_index[cell] as a write cursor, then shift the cursors back
+	for (uint32_t i = 0; i < entities_count; i++) {
+		uint32_t sorted_index = grid->cells_first_index[grid->entity_cells[i]]++;
+		grid->sorted_indices[sorted_index] = i;
+		grid->sorted_positions_x[sorted_index] = positions_x[i];
+		grid->sorted_positions_y[sorted_index] = positions_y[i];
+	}
+
+	memmove(grid->cells_first_index + 1, grid->cells_first_index, cells_count * sizeof (uint32_t));
+	grid->cells_first_index[0] = 0;
+	return true;
+}
+
+uint32_t querySpatialGrid(SpatialGrid const *grid, SpatialGridQuery *query, Vector2 center, float radius)
+{
+	uint16_t first_column = getClampedCellCoordinate(center.x - radius, grid->inverse_cell_size, grid->columns_count);
+	uint16_t last_column = getClampedCellCoordinate(center.x + radius, grid->inverse_cell_size, grid->columns_count);
+	uint16_t first_row = getClampedCellCoordinate(center.y - radius, grid->inverse_cell_size, grid->rows_count);
+	uint16_t last_row = getClampedCellCoordinate(center.y + radius, grid->inverse_cell_size, grid->rows_count);
+
+	uint32_t indices_count = 0;
+	for (uint16_t row = first_row; row <= last_row; row++) {
+		// Cells in a row are contiguous in sorted_indices
+		uint32_t first_index = grid->cells_first_index[row * grid->columns_count + first_column];
+		uint32_t last_index = grid->cells_first_index[row * grid->columns_count + last_column + 1];
+
+		memcpy(query->indices + indices_count, grid->sorted_indices + first_index, (last_index - first_index) * sizeof (uint32_t));
+		memcpy(query->positions_x + indices_count, grid->sorted_positions_x + first_index, (last_index - first_index) * sizeof (float));
+		memcpy(query->positions_y + indices_count, grid->sorted_positions_y + first_index, (last_index - first_index) * sizeof (float));
+		indices_count += last_index - first_index;
+	}
+
+	return indices_count;
+}
@@ -0,0 +1,48 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <raylib.h>
+
+// Uniform grid over a fixed area, rebuilt from scratch every tick with a
+// counting sort. Entities outside the area are clamped into the edge cells.
+typedef struct {
+	uint32_t *cells_first_index; // columns_count * rows_count + 1 prefix sums into sorted_indices
+	uint32_t *sorted_indices;
+	float *sorted_positions_x; // Positions in sorted_indices order, so queries copy runs instead of gathering
+	float *sorted_positions_y;
+	uint32_t *entity_cells;
+	float inverse_cell_size;
+	uint16_t columns_count;
+	uint16_t rows_count;
+	uint32_t maximum_entities_count;
+} SpatialGrid;
+
+// Output of a query, kept apart from the grid so each thread can query with its own
+typedef struct {
+	uint32_t *indices;
+	float *positions_x; // positions_*[k] is the position of entity indices[k]
+	float *positions_y;
+	uint32_t capacity;
+} SpatialGridQuery;
+
+void initSpatialGrid(SpatialGrid *grid, float width, float height, float cell_size, uint32_t maximum_entities_count);
+// False if it couldn't allocate, leaving the grid as it was
+bool reserveSpatialGrid(SpatialGrid *grid, uint32_t maximum_entities_count);
+
+// Never allocates: false, with nothing rebuilt, if entities_count exceeds
+// what was reserved
+bool rebuildSpatialGrid(SpatialGrid *grid, float const *positions_x, float const *positions_y, uint32_t entities_count);
+
+// False if it couldn't allocate, leaving query empty
+bool reserveSpatialGridQuery(SpatialGridQuery *query, uint32_t capacity);
+
+// Fills query with every entity in the cells overlapping the circle's
+// bounding box; query must hold as many entities as the grid was last rebuilt
+// with. Callers still do the exact distance test, e.g. with a
+// RangeFilterKernels function.
+uint32_t querySpatialGrid(SpatialGrid const *grid, SpatialGridQuery *query, Vector2 center, float radius);
+
+#endif
@@ -0,0 +1,17 @@
+#include <stdlib.h>
+
+#include "spawn_queue.h"
+
+bool reserveSpawnQueue(SpawnQueue *queue, uint32_t capacity)
+{
+	if (capacity <= queue->capacity)
+		return true;
+
+	Spawn *spawns = realloc(queue->spawns, capacity * sizeof (Spawn));
+	if (spawns == NULL)
+		return false;
+
+	queue->spawns = spawns;
+	queue->capacity = capacity;
+	return true;
+}
@@ -0,0 +1,45 @@
+#ifndef SPAWN_QUEUE_H
+#define SPAWN_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+	float seconds; // Since the wave started
+	uint8_t type;
+} Spawn;
+
+// One wave's spawns, built in time order when the wave starts, so a tick
+// only ever looks at the front and pops what has come due. Building is the
+// only time it allocates, and then only if the wave outgrows every earlier one.
+typedef struct {
+	Spawn *spawns;
+	uint32_t count;
+	uint32_t next_index; // The front; everything before it has spawned
+	uint32_t capacity;
+} SpawnQueue;
+
+// Keeps the contents; false if it can't grow
+bool reserveSpawnQueue(SpawnQueue *queue, uint32_t capacity);
+
+// Appends in time order; the caller reserves first
+static inline void pushSpawn(SpawnQueue *queue, Spawn spawn)
+{
+	queue->spawns[queue->count++] = spawn;
+}
+
+// The next spawn due by seconds, if any; call until it returns NULL
+static inline Spawn const *popDueSpawn(SpawnQueue *queue, float seconds)
+{
+	if (queue->next_index == queue->count || queue->spawns[queue->next_index].seconds > seconds)
+		return NULL;
+	return &queue->spawns[queue->next_index++];
+}
+
+static inline void clearSpawnQueue(SpawnQueue *queue)
+{
+	queue->count = 0;
+	queue->next_index = 0;
+}
+
+#endif
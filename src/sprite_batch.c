@@ -0,0 +1,117 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include <rlgl.h>
+
+#include "sprite_batch.h"
+
+static bool reserveSpriteBatch(SpriteBatch *batch, uint32_t capacity)
+{
+	Sprite *sprites = realloc(batch->sprites, capacity * sizeof (Sprite));
+	if (sprites == NULL)
+		return false;
+	batch->sprites = sprites;
+
+	Sprite *sorted_sprites = realloc(batch->sorted_sprites, capacity * sizeof (Sprite));
+	if (sorted_sprites == NULL)
+		return false;
+	batch->sorted_sprites = sorted_sprites;
+
+	batch->capacity = capacity;
+	return true;
+}
+
+void initSpriteBatch(SpriteBatch *batch, Texture2D texture, uint32_t capacity)
+{
+	*batch = (SpriteBatch) {
+		.texture = texture,
+	};
+	reserveSpriteBatch(batch, capacity);
+}
+
+void pushSprite(SpriteBatch *batch, SpriteLayer layer, Rectangle source, Rectangle destination, float angle, Color tint)
+{
+	if (batch->sprites_count == batch->capacity && !reserveSpriteBatch(batch, batch->capacity > 0 ? batch->capacity * 2 : 256))
+		return;
+
+	batch->sprites[batch->sprites_count++] = (Sprite) {
+		.source = source,
+		.destination = destination,
+		.angle = angle,
+		.tint = tint,
+		.layer = layer,
+	};
+	batch->layers_sprites_count[layer]++;
+}
+
+void flushSpriteBatch(SpriteBatch *batch)
+{
+	// Counting sort by layer; stable, so each layer keeps push order
+	uint32_t layers_first_index[SPRITE_LAYERS_COUNT];
+	uint32_t first_index = 0;
+	for (uint8_t layer = 0; layer < SPRITE_LAYERS_COUNT; layer++) {
+		layers_first_index[layer] = first_index;
+		first_index += batch->layers_sprites_count[layer];
+	}
+	for (uint32_t i = 0; i < batch->sprites_count; i++)
+		batch->sorted_sprites[layers_first_index[batch->sprites[i].layer]++] = batch->sprites[i];
+
+	// Submit whatever was drawn before us, so the count below is ours alone
+	rlDrawRenderBatchActive();
+	uint32_t draw_calls_count = 0;
+
+	float inverse_texture_width = 1.f / batch->texture.width;
+	float inverse_texture_height = 1.f / batch->texture.height;
+
+	rlSetTexture(batch->texture.id);
+	rlBegin(RL_QUADS);
+	rlNormal3f(0.f, 0.f, 1.f);
+
+	for (uint32_t i = 0; i < batch->sprites_count; i++) {
+		Sprite const *sprite = &batch->sorted_sprites[i];
+
+		if (rlCheckRenderBatchLimit(4))
+			draw_calls_count++;
+
+		// Corners relative to the centre, rotated, in DrawTexturePro()'s winding
+		float sine = sinf(sprite->angle * DEG2RAD);
+		float cosine = cosf(sprite->angle * DEG2RAD);
+		float half_width = sprite->destination.width / 2;
+		float half_height = sprite->destination.height / 2;
+		float corners_x[4] = {-half_width, -half_width, half_width, half_width};
+		float corners_y[4] = {-half_height, half_height, half_height, -half_height};
+
+		float left_u = sprite->source.x * inverse_texture_width;
+		float right_u = (sprite->source.x + sprite->source.width) * inverse_texture_width;
+		float top_v = sprite->source.y * inverse_texture_height;
+		float bottom_v = (sprite->source.y + sprite->source.height) * inverse_texture_height;
+		float corners_u[4] = {left_u, left_u, right_u, right_u};
+		float corners_v[4] = {top_v, bottom_v, bottom_v, top_v};
+
+		rlColor4ub(sprite->tint.r, sprite->tint.g, sprite->tint.b, sprite->tint.a);
+		for (uint8_t corner = 0; corner < 4; corner++) {
+			rlTexCoord2f(corners_u[corner], corners_v[corner]);
+			rlVertex2f(
+				sprite->destination.x + corners_x[corner] * cosine - corners_y[corner] * sine,
+				sprite->destination.y + corners_x[corner] * sine + corners_y[corner] * cosine
+			);
+		}
+	}
+
+	rlEnd();
+	rlSetTexture(0);
+
+	if (batch->sprites_count > 0) {
+		rlDrawRenderBatchActive();
+		draw_calls_count++;
+	}
+
+	batch->last_flush_stats = (SpriteBatchStats) {
+		.sprites_count = batch->sprites_count,
+		.draw_calls_count = draw_calls_count,
+	};
+
+	batch->sprites_count = 0;
+	for (uint8_t layer = 0; layer < SPRITE_LAYERS_COUNT; layer++)
+		batch->layers_sprites_count[layer] = 0;
+}
@@ -0,0 +1,49 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <stdint.h>
+
+#include <raylib.h>
+
+typedef enum { // Draw order
+	SPRITE_LAYER_OUTPOST_BASES,
+	SPRITE_LAYER_TANKS,
+	SPRITE_LAYER_OUTPOST_TURRETS,
+	SPRITE_LAYERS_COUNT,
+} SpriteLayer;
+
+typedef struct {
+	Rectangle source;
+	Rectangle destination; // x, y is the centre, which is also the pivot
+	float angle; // Degrees, as for DrawTexturePro()
+	Color tint;
+	uint8_t layer;
+} Sprite;
+
+typedef struct {
+	uint32_t sprites_count;
+	uint32_t draw_calls_count;
+} SpriteBatchStats;
+
+// Collects a frame's atlas quads, then submits them layer by layer through
+// rlgl with a single texture bind, so the only draw calls are the ones
+// forced by rlgl's vertex buffer filling up
+typedef struct {
+	Texture2D texture;
+	Sprite *sprites;
+	Sprite *sorted_sprites;
+	uint32_t sprites_count;
+	uint32_t capacity;
+	uint32_t layers_sprites_count[SPRITE_LAYERS_COUNT];
+	SpriteBatchStats last_flush_stats;
+} SpriteBatch;
+
+void initSpriteBatch(SpriteBatch *batch, Texture2D texture, uint32_t capacity);
+
+// Grows as needed; drops the sprite if it can't
+void pushSprite(SpriteBatch *batch, SpriteLayer layer, Rectangle source, Rectangle destination, float angle, Color tint);
+
+// Draws everything pushed since the last flush, then empties the batch
+void flushSpriteBatch(SpriteBatch *batch);
+
+#endif
@@ -0,0 +1,152 @@
+#include <math.h>
+#include <string.h>
+
+#include <rlgl.h>
+
+#include "text_cache.h"
+
+#define DEFAULT_FONT_SIZE 10 // What DrawText() measures spacing against, and its smallest size
+
+// Follows DrawText() and DrawTextEx(), so cached text lands on the same pixels
+static void layOutText(TextLayout *layout, char const *text, uint16_t font_size)
+{
+	size_t length = strnlen(text, TEXT_CACHE_TEXT_SIZE - 1);
+	memcpy(layout->text, text, length);
+	layout->text[length] = '\0';
+	layout->font_size = font_size;
+	layout->quads_count = 0;
+	layout->size = (Vector2) {};
+
+	Font font = GetFontDefault();
+	if (font.texture.id == 0)
+		return;
+
+	uint16_t drawn_font_size = font_size < DEFAULT_FONT_SIZE ? DEFAULT_FONT_SIZE : font_size;
+	float spacing = drawn_font_size / DEFAULT_FONT_SIZE; // Whole pixels, as DrawText() has it
+	float scale = (float) drawn_font_size / font.baseSize;
+	float padding = font.glyphPadding;
+
+	float x = 0;
+	uint8_t glyphs_count = 0;
+	for (size_t i = 0; i < length;) {
+		int codepoint_size;
+		int codepoint = GetCodepointNext(&layout->text[i], &codepoint_size);
+		i += codepoint_size;
+
+		int index = GetGlyphIndex(font, codepoint);
+		Rectangle rectangle = font.recs[index];
+		GlyphInfo glyph = font.glyphs[index];
+
+		if (codepoint != ' ' && codepoint != '\t') {
+			layout->quads[layout->quads_count++] = (TextQuad) {
+				.destination = {
+					.x = x + (glyph.offsetX - padding) * scale,
+					.y = (glyph.offsetY - padding) * scale,
+					.width = (rectangle.width + 2 * padding) * scale,
+					.height = (rectangle.height + 2 * padding) * scale,
+				},
+				.uv = {
+					.x = (rectangle.x - padding) / font.texture.width,
+					.y = (rectangle.y - padding) / font.texture.height,
+					.width = (rectangle.width + 2 * padding) / font.texture.width,
+					.height = (rectangle.height + 2 * padding) / font.texture.height,
+				},
+			};
+		}
+
+		x += (glyph.advanceX != 0 ? glyph.advanceX : rectangle.width) * scale + spacing;
+		glyphs_count++;
+	}
+
+	layout->size = (Vector2) {glyphs_count > 0 ? x - spacing : 0, drawn_font_size};
+}
+
+TextLayout const *getTextLayout(TextCache *cache, char const *text, uint16_t font_size)
+{
+	cache->uses_count++;
+
+	TextLayout *least_recent_layout = &cache->layouts[0];
+	for (uint8_t i = 0; i < TEXT_CACHE_LAYOUTS_COUNT; i++) {
+		TextLayout *layout = &cache->layouts[i];
+		if (layout->font_size == font_size && strncmp(layout->text, text, TEXT_CACHE_TEXT_SIZE - 1) == 0) {
+			layout->last_use = cache->uses_count;
+			return layout;
+		}
+
+		if (layout->last_use < least_recent_layout->last_use)
+			least_recent_layout = layout;
+	}
+
+	layOutText(least_recent_layout, text, font_size);
+	least_recent_layout->last_use = cache->uses_count;
+	return least_recent_layout;
+}
+
+void drawTextLayout(TextLayout const *layout, Vector2 position, Color tint)
+{
+	if (layout->quads_count == 0)
+		return;
+
+	rlSetTexture(GetFontDefault().texture.id);
+	rlBegin(RL_QUADS);
+	rlNormal3f(0.f, 0.f, 1.f);
+
+	for (uint8_t i = 0; i < layout->quads_count; i++) {
+		TextQuad const *quad = &layout->quads[i];
+		rlCheckRenderBatchLimit(4);
+
+		float left = position.x + quad->destination.x;
+		float top = position.y + quad->destination.y;
+		float right = left + quad->destination.width;
+		float bottom = top + quad->destination.height;
+
+		// DrawTexturePro()'s winding
+		rlColor4ub(tint.r, tint.g, tint.b, tint.a);
+		rlTexCoord2f(quad->uv.x, quad->uv.y);
+		rlVertex2f(left, top);
+		rlTexCoord2f(quad->uv.x, quad->uv.y + quad->uv.height);
+		rlVertex2f(left, bottom);
+		rlTexCoord2f(quad->uv.x + quad->uv.width, quad->uv.y + quad->uv.height);
+		rlVertex2f(right, bottom);
+		rlTexCoord2f(quad->uv.x + quad->uv.width, quad->uv.y);
+		rlVertex2f(right, top);
+	}
+
+	rlEnd();
+	rlSetTexture(0);
+}
+
+void bakeText(BakedText *baked_text, TextCache *cache, char const *text, uint16_t font_size)
+{
+	if (baked_text->texture.id != 0)
+		UnloadRenderTexture(baked_text->texture);
+	*baked_text = (BakedText) {};
+
+	TextLayout const *layout = getTextLayout(cache, text, font_size);
+	if (layout->size.x == 0)
+		return;
+
+	baked_text->size = layout->size;
+	baked_text->texture = LoadRenderTexture(ceilf(layout->size.x), ceilf(layout->size.y));
+	SetTextureFilter(baked_text->texture.texture, TEXTURE_FILTER_BILINEAR); // Drawn scaled and rotated
+
+	BeginTextureMode(baked_text->texture);
+	ClearBackground((Color) {255, 255, 255, 0}); // Transparent white, so filtered edges don't darken
+	drawTextLayout(layout, (Vector2) {0, 0}, WHITE);
+	EndTextureMode();
+}
+
+void drawBakedText(BakedText const *baked_text, Vector2 position, Vector2 origin, float rotation, float scale, Color tint)
+{
+	if (baked_text->texture.id == 0)
+		return;
+
+	DrawTexturePro(
+		baked_text->texture.texture,
+		(Rectangle) {0, 0, baked_text->size.x, -baked_text->size.y}, // Render textures are stored upside down
+		(Rectangle) {position.x, position.y, baked_text->size.x * scale, baked_text->size.y * scale},
+		origin,
+		rotation,
+		tint
+	);
+}
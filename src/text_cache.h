@@ -0,0 +1,56 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <stdint.h>
+
+#include <raylib.h>
+
+#define TEXT_CACHE_TEXT_SIZE 64 // Including the terminator; longer text is cut short
+#define TEXT_CACHE_LAYOUTS_COUNT 16
+
+typedef struct {
+	Rectangle destination; // From the text's top left
+	Rectangle uv; // In the font texture, normalised
+} TextQuad;
+
+// One line of raylib's default font at one size, measured and turned into
+// glyph quads exactly as DrawText() would
+typedef struct {
+	char text[TEXT_CACHE_TEXT_SIZE];
+	uint16_t font_size; // 0 while free
+	Vector2 size; // What MeasureText() gives, by font_size
+	TextQuad quads[TEXT_CACHE_TEXT_SIZE - 1]; // Spaces take none
+	uint8_t quads_count;
+	uint32_t last_use;
+} TextLayout;
+
+// Lays text out once per (text, font size) rather than every frame. Keyed
+// by content, so text changed in place, e.g. by strcpy(), simply misses and
+// is laid out anew, evicting the least recently used layout.
+typedef struct {
+	TextLayout layouts[TEXT_CACHE_LAYOUTS_COUNT];
+	uint32_t uses_count;
+} TextCache;
+
+// Needs the window up, for the default font
+TextLayout const *getTextLayout(TextCache *cache, char const *text, uint16_t font_size);
+
+// The quads in one texture bind, with position as the top left
+void drawTextLayout(TextLayout const *layout, Vector2 position, Color tint);
+
+// Text that never changes, rendered once in white so any tint applies and
+// drawn as a single quad after that
+typedef struct {
+	RenderTexture2D texture;
+	Vector2 size;
+} BakedText;
+
+// Bakes text at font_size, replacing whatever baked_text held; don't call
+// between BeginTextureMode() and EndTextureMode()
+void bakeText(BakedText *baked_text, TextCache *cache, char const *text, uint16_t font_size);
+
+// Like DrawTextPro(): position is where origin, in the scaled text, lands,
+// and the text rotates around it
+void drawBakedText(BakedText const *baked_text, Vector2 position, Vector2 origin, float rotation, float scale, Color tint);
+
+#endif
@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "trace.h"
+
+Trace trace;
+
+bool startTracing(uint32_t capacity)
+{
+	TraceSpan *spans = malloc(capacity * sizeof (TraceSpan));
+	if (spans == NULL)
+		return false;
+
+	trace = (Trace) {
+		.spans = spans,
+		.capacity = capacity,
+		.origin_seconds = getTraceSeconds(),
+		.is_enabled = true,
+	};
+	return true;
+}
+
+bool stopTracing(char const *path)
+{
+	if (!trace.is_enabled)
+		return false;
+	trace.is_enabled = false;
+
+	FILE *file = fopen(path, "w");
+	if (file == NULL) {
+		free(trace.spans);
+		return false;
+	}
+
+	// Complete ("X") events nest by time alone, so no begin/end pairing is needed
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_spans\":%llu},\"traceEvents\":[\n", (unsigned long long) trace.dropped_spans_count);
+	fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"citadel\"}}");
+	for (uint32_t i = 0; i < trace.spans_count; i++) {
+		fprintf(
+			file,
+			",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+			trace.spans[i].name,
+			(trace.spans[i].start_seconds - trace.origin_seconds) * 1e6,
+			trace.spans[i].duration_seconds * 1e6
+		);
+	}
+	fprintf(file, "\n]}\n");
+
+	free(trace.spans);
+	trace.spans = NULL;
+	return fclose(file) == 0;
+}
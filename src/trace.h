@@ -0,0 +1,78 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#define TRACE_DEFAULT_SPANS_CAPACITY (1 << 20) // 24 MiB; about an hour of frames
+
+typedef struct {
+	char const *name; // Must outlive the trace, e.g. a string literal
+	double start_seconds;
+	float duration_seconds;
+} TraceSpan;
+
+// One process-wide buffer of completed spans, allocated up front by
+// startTracing(), so recording never allocates or does I/O. Spans are only
+// recorded from the main thread. Once full, further spans are counted and
+// dropped.
+typedef struct {
+	TraceSpan *spans;
+	uint32_t spans_count;
+	uint32_t capacity;
+	uint64_t dropped_spans_count;
+	double origin_seconds;
+	bool is_enabled;
+} Trace;
+
+extern Trace trace;
+
+static inline double getTraceSeconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Returns 0 while tracing is off, so a span costs one branch either way
+static inline double beginTraceSpan(void)
+{
+	return trace.is_enabled ? getTraceSeconds() : 0.;
+}
+
+static inline void recordTraceSpan(char const *name, double start_seconds, double end_seconds)
+{
+	if (!trace.is_enabled)
+		return;
+
+	if (trace.spans_count == trace.capacity) {
+		trace.dropped_spans_count++;
+		return;
+	}
+	trace.spans[trace.spans_count++] = (TraceSpan) {name, start_seconds, end_seconds - start_seconds};
+}
+
+static inline void endTraceSpan(char const *name, double start_seconds)
+{
+	if (trace.is_enabled)
+		recordTraceSpan(name, start_seconds, getTraceSeconds());
+}
+
+// Records the statement or block that follows as a span called name; as
+// with PROFILE_PHASE(), don't break out of it
+#define TRACE_SPAN(name)\
+	for (\
+		double trace_span_start_seconds = beginTraceSpan(), *trace_span_pending = &trace_span_start_seconds;\
+		trace_span_pending != NULL;\
+		trace_span_pending = NULL, endTraceSpan(name, trace_span_start_seconds)\
+	)
+
+// Returns false if the buffer can't be allocated, leaving tracing off
+bool startTracing(uint32_t capacity);
+
+// Writes everything recorded as Chrome trace-event JSON, for Perfetto or
+// chrome://tracing, then stops tracing and frees the buffer
+bool stopTracing(char const *path);
+
+#endif
@@ -0,0 +1,176 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include <raymath.h>
+#include <rlgl.h>
+
+#include "trail_mesh.h"
+
+static bool reserveTrailMesh(TrailMesh *mesh, uint32_t capacity)
+{
+	if (capacity <= mesh->capacity)
+		return true;
+
+	uint32_t new_capacity = mesh->capacity > 0 ? mesh->capacity : 1024;
+	while (new_capacity < capacity)
+		new_capacity *= 2;
+
+	TrailVertex *vertices = realloc(mesh->vertices, new_capacity * sizeof (TrailVertex));
+	if (vertices == NULL)
+		return false;
+
+	mesh->vertices = vertices;
+	mesh->capacity = new_capacity;
+	return true;
+}
+
+void initTrailMesh(TrailMesh *mesh, uint32_t capacity)
+{
+	*mesh = (TrailMesh) {
+		.pixels_per_unit = 1.f,
+	};
+	reserveTrailMesh(mesh, capacity);
+}
+
+// Enough segments that none spans more than TRAIL_PIXELS_PER_SEGMENT on screen
+static uint32_t getSegmentsCount(TrailMesh const *mesh, float length, uint32_t minimum_segments_count)
+{
+	uint32_t segments_count = ceilf(length * mesh->pixels_per_unit / TRAIL_PIXELS_PER_SEGMENT);
+	if (segments_count < minimum_segments_count)
+		return minimum_segments_count;
+	if (segments_count > TRAIL_MAXIMUM_SEGMENTS_COUNT)
+		return TRAIL_MAXIMUM_SEGMENTS_COUNT;
+	return segments_count;
+}
+
+static Color lerpColor(Color from, Color to, float amount)
+{
+	return (Color) {
+		.r = from.r + (to.r - from.r) * amount,
+		.g = from.g + (to.g - from.g) * amount,
+		.b = from.b + (to.b - from.b) * amount,
+		.a = from.a + (to.a - from.a) * amount,
+	};
+}
+
+static inline void pushTriangle(TrailMesh *mesh, TrailVertex a, TrailVertex b, TrailVertex c)
+{
+	mesh->vertices[mesh->vertices_count++] = a;
+	mesh->vertices[mesh->vertices_count++] = b;
+	mesh->vertices[mesh->vertices_count++] = c;
+}
+
+// The strip's two vertices at point s, half the thickness out along its normal
+static void getStripEdge(Vector2 const *points, Vector2 const *tangents, Color const *colors, uint32_t s, float thickness, TrailVertex *left, TrailVertex *right)
+{
+	Vector2 tangent = Vector2Normalize(tangents[s]);
+	Vector2 offset = {-tangent.y * thickness / 2, tangent.x * thickness / 2};
+
+	*left = (TrailVertex) {Vector2Add(points[s], offset), colors[s]};
+	*right = (TrailVertex) {Vector2Subtract(points[s], offset), colors[s]};
+}
+
+// Thick strip along points[0..segments_count], so neighbouring segments
+// share their edge
+static void pushStrip(TrailMesh *mesh, Vector2 const *points, Vector2 const *tangents, Color const *colors, uint32_t segments_count, float thickness)
+{
+	if (!reserveTrailMesh(mesh, mesh->vertices_count + 6 * segments_count))
+		return;
+
+	TrailVertex previous_left;
+	TrailVertex previous_right;
+	getStripEdge(points, tangents, colors, 0, thickness, &previous_left, &previous_right);
+
+	for (uint32_t s = 1; s <= segments_count; s++) {
+		TrailVertex left;
+		TrailVertex right;
+		getStripEdge(points, tangents, colors, s, thickness, &left, &right);
+
+		// Wound as raylib's shapes, so culling keeps them
+		pushTriangle(mesh, previous_left, right, previous_right);
+		pushTriangle(mesh, previous_left, left, right);
+
+		previous_left = left;
+		previous_right = right;
+	}
+}
+
+void pushTrailBezier(TrailMesh *mesh, Vector2 start, Vector2 control, Vector2 end, float thickness, Color start_color, Color end_color)
+{
+	// The control polygon is never shorter than the curve
+	uint32_t segments_count = getSegmentsCount(mesh, Vector2Distance(start, control) + Vector2Distance(control, end), 1);
+
+	Vector2 points[TRAIL_MAXIMUM_SEGMENTS_COUNT + 1];
+	Vector2 tangents[TRAIL_MAXIMUM_SEGMENTS_COUNT + 1];
+	Color colors[TRAIL_MAXIMUM_SEGMENTS_COUNT + 1];
+	for (uint32_t s = 0; s <= segments_count; s++) {
+		float t = (float) s / segments_count;
+		float u = 1.f - t;
+
+		points[s] = (Vector2) {
+			u * u * start.x + 2.f * u * t * control.x + t * t * end.x,
+			u * u * start.y + 2.f * u * t * control.y + t * t * end.y,
+		};
+		tangents[s] = Vector2Add(Vector2Scale(Vector2Subtract(control, start), u), Vector2Scale(Vector2Subtract(end, control), t));
+		colors[s] = lerpColor(start_color, end_color, t);
+	}
+
+	pushStrip(mesh, points, tangents, colors, segments_count, thickness);
+}
+
+void pushTrailLine(TrailMesh *mesh, Vector2 start, Vector2 end, float thickness, Color start_color, Color end_color)
+{
+	Vector2 direction = Vector2Subtract(end, start);
+	pushStrip(mesh, (Vector2 []) {start, end}, (Vector2 []) {direction, direction}, (Color []) {start_color, end_color}, 1, thickness);
+}
+
+void pushTrailDisc(TrailMesh *mesh, Vector2 center, float radius, Color center_color, Color edge_color)
+{
+	uint32_t segments_count = getSegmentsCount(mesh, 2.f * PI * radius, 8);
+	if (!reserveTrailMesh(mesh, mesh->vertices_count + 3 * segments_count))
+		return;
+
+	TrailVertex middle = {center, center_color};
+	TrailVertex previous_edge = {{center.x + radius, center.y}, edge_color};
+	for (uint32_t s = 1; s <= segments_count; s++) {
+		float angle = 2.f * PI * s / segments_count;
+		TrailVertex edge = {{center.x + radius * cosf(angle), center.y + radius * sinf(angle)}, edge_color};
+
+		pushTriangle(mesh, middle, edge, previous_edge);
+		previous_edge = edge;
+	}
+}
+
+void flushTrailMesh(TrailMesh *mesh)
+{
+	// Submit whatever was drawn before us, so the count below is ours alone
+	rlDrawRenderBatchActive();
+	uint32_t draw_calls_count = 0;
+
+	rlBegin(RL_TRIANGLES);
+
+	for (uint32_t i = 0; i < mesh->vertices_count; i += 3) {
+		if (rlCheckRenderBatchLimit(3))
+			draw_calls_count++;
+
+		for (uint8_t corner = 0; corner < 3; corner++) {
+			TrailVertex const *vertex = &mesh->vertices[i + corner];
+			rlColor4ub(vertex->color.r, vertex->color.g, vertex->color.b, vertex->color.a);
+			rlVertex2f(vertex->position.x, vertex->position.y);
+		}
+	}
+
+	rlEnd();
+
+	if (mesh->vertices_count > 0) {
+		rlDrawRenderBatchActive();
+		draw_calls_count++;
+	}
+
+	mesh->last_flush_stats = (TrailMeshStats) {
+		.triangles_count = mesh->vertices_count / 3,
+		.draw_calls_count = draw_calls_count,
+	};
+
+	mesh->vertices_count = 0;
+}
@@ -0,0 +1,43 @@
+#ifndef TRAIL_MESH_H
+#define TRAIL_MESH_H
+
+#include <stdint.h>
+
+#include <raylib.h>
+
+#define TRAIL_PIXELS_PER_SEGMENT 12.f // Finer than this isn't visible on a curve
+#define TRAIL_MAXIMUM_SEGMENTS_COUNT 64
+
+typedef struct {
+	Vector2 position;
+	Color color;
+} TrailVertex;
+
+typedef struct {
+	uint32_t triangles_count;
+	uint32_t draw_calls_count;
+} TrailMeshStats;
+
+// Collects a frame's shot trails as untextured triangles, tessellated on the
+// CPU with per-vertex colours, then submits them all in one rlgl batch, so
+// the only draw calls are the ones forced by its vertex buffer filling up
+typedef struct {
+	TrailVertex *vertices; // Three per triangle
+	uint32_t vertices_count;
+	uint32_t capacity;
+	float pixels_per_unit; // Scale from drawing coordinates to the screen, for sizing segments
+	TrailMeshStats last_flush_stats;
+} TrailMesh;
+
+void initTrailMesh(TrailMesh *mesh, uint32_t capacity);
+
+// Each of these grows the mesh as needed, dropping the shape if it can't.
+// Colours blend from start to end along the trail, or centre to edge.
+void pushTrailBezier(TrailMesh *mesh, Vector2 start, Vector2 control, Vector2 end, float thickness, Color start_color, Color end_color);
+void pushTrailLine(TrailMesh *mesh, Vector2 start, Vector2 end, float thickness, Color start_color, Color end_color);
+void pushTrailDisc(TrailMesh *mesh, Vector2 center, float radius, Color center_color, Color edge_color);
+
+// Draws everything pushed since the last flush, then empties the mesh
+void flushTrailMesh(TrailMesh *mesh);
+
+#endif
@@ -0,0 +1,94 @@
+#include <unistd.h> // sysconf()
+
+#include "worker_pool.h"
+
+static void *runWorkerThread(void *argument)
+{
+	WorkerThread const *worker = argument;
+	WorkerPool *pool = worker->pool;
+	uint32_t seen_generation = 0;
+
+	pthread_mutex_lock(&pool->mutex);
+	for (;;) {
+		while (pool->task_generation == seen_generation)
+			pthread_cond_wait(&pool->task_posted, &pool->mutex);
+		seen_generation = pool->task_generation;
+
+		if (worker->index >= pool->task_workers_count)
+			continue;
+
+		WorkerTask task = pool->task;
+		void *context = pool->task_context;
+		uint32_t workers_count = pool->task_workers_count;
+		pthread_mutex_unlock(&pool->mutex);
+
+		task(context, worker->index, workers_count);
+
+		pthread_mutex_lock(&pool->mutex);
+		if (--pool->pending_workers_count == 0)
+			pthread_cond_signal(&pool->task_finished);
+	}
+
+	return NULL;
+}
+
+void initWorkerPool(WorkerPool *pool, uint32_t workers_count)
+{
+	if (workers_count == 0) {
+		long online_processors_count = sysconf(_SC_NPROCESSORS_ONLN);
+		workers_count = online_processors_count > 0 ? online_processors_count : 1;
+	}
+	if (workers_count > WORKER_POOL_MAXIMUM_WORKERS_COUNT)
+		workers_count = WORKER_POOL_MAXIMUM_WORKERS_COUNT;
+
+	*pool = (WorkerPool) {
+		.workers_count = 1,
+	};
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->task_posted, NULL);
+	pthread_cond_init(&pool->task_finished, NULL);
+
+	for (uint32_t i = 1; i < workers_count; i++) {
+		pool->workers[i] = (WorkerThread) {pool, i};
+		if (pthread_create(&pool->threads[i], NULL, runWorkerThread, &pool->workers[i]) != 0)
+			break;
+		pool->workers_count++;
+	}
+}
+
+void runWorkerPool(WorkerPool *pool, WorkerTask task, void *context, uint32_t workers_count)
+{
+	if (workers_count > pool->workers_count)
+		workers_count = pool->workers_count;
+
+	if (workers_count <= 1) {
+		task(context, 0, 1);
+		return;
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->task = task;
+	pool->task_context = context;
+	pool->task_workers_count = workers_count;
+	pool->pending_workers_count = workers_count - 1;
+	pool->task_generation++;
+	pthread_cond_broadcast(&pool->task_posted);
+	pthread_mutex_unlock(&pool->mutex);
+
+	task(context, 0, workers_count);
+
+	pthread_mutex_lock(&pool->mutex);
+	while (pool->pending_workers_count > 0)
+		pthread_cond_wait(&pool->task_finished, &pool->mutex);
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+void getWorkerRange(uint32_t items_count, uint32_t granularity, uint32_t worker_index, uint32_t workers_count, uint32_t *first, uint32_t *last)
+{
+	uint64_t blocks_count = (items_count + (uint64_t) granularity - 1) / granularity;
+	uint64_t first_item = blocks_count * worker_index / workers_count * granularity;
+	uint64_t last_item = blocks_count * (worker_index + 1) / workers_count * granularity;
+
+	*first = first_item < items_count ? first_item : items_count;
+	*last = last_item < items_count ? last_item : items_count;
+}
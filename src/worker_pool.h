@@ -0,0 +1,49 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#define WORKER_POOL_MAXIMUM_WORKERS_COUNT 16
+
+// Runs on every participating worker; worker 0 is always the calling thread
+typedef void (*WorkerTask)(void *context, uint32_t worker_index, uint32_t workers_count);
+
+typedef struct WorkerPool WorkerPool;
+
+typedef struct {
+	WorkerPool *pool;
+	uint32_t index;
+} WorkerThread;
+
+// Fork-join pool of persistent threads; the caller takes part in every run,
+// so a pool of one never starts a thread. Must not move once initialised.
+struct WorkerPool {
+	pthread_t threads[WORKER_POOL_MAXIMUM_WORKERS_COUNT];
+	WorkerThread workers[WORKER_POOL_MAXIMUM_WORKERS_COUNT];
+
+	pthread_mutex_t mutex;
+	pthread_cond_t task_posted;
+	pthread_cond_t task_finished;
+
+	WorkerTask task;
+	void *task_context;
+	uint32_t task_workers_count;
+	uint32_t task_generation;
+	uint32_t pending_workers_count;
+
+	uint32_t workers_count; // Including the calling thread
+};
+
+// 0 means one worker per online CPU; capped at WORKER_POOL_MAXIMUM_WORKERS_COUNT.
+// Falls back to fewer workers if threads can't be started.
+void initWorkerPool(WorkerPool *pool, uint32_t workers_count);
+
+// Runs task on up to workers_count workers and returns once all are done
+void runWorkerPool(WorkerPool *pool, WorkerTask task, void *context, uint32_t workers_count);
+
+// Worker worker_index's share of [0, items_count), as near-equal contiguous
+// ranges whose boundaries fall on multiples of granularity
+void getWorkerRange(uint32_t items_count, uint32_t granularity, uint32_t worker_index, uint32_t workers_count, uint32_t *first, uint32_t *last);
+
+#endif
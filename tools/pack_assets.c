@@ -0,0 +1,151 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <raylib.h> // Only its loaders and encoders; no window is ever opened
+
+#include "asset_pack.h"
+
+#define PACK_MAXIMUM_ENTRIES_COUNT 64
+
+// citadel-pack <pack> <asset>...
+//
+// Does the decoding the game would otherwise do at every startup, once:
+// PNGs become raw RGBA8 pixels, uploaded as they are, and MP3/OGG/WAV/FLAC
+// audio becomes QOA, which raylib still streams but decodes with a few
+// shifts and multiplies per sample instead of MP3's transforms, at about a
+// quarter of the size of raw PCM.
+
+typedef struct {
+	AssetPackEntry entry;
+	unsigned char *data; // From raylib, released once copied
+} PackedAsset;
+
+static size_t alignPackOffset(size_t offset)
+{
+	return (offset + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+}
+
+static bool packImage(PackedAsset *asset, char const *path)
+{
+	Image image = LoadImage(path);
+	if (image.data == NULL)
+		return false;
+
+	ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+	asset->entry.type = ASSET_PACK_IMAGE;
+	asset->entry.size = GetPixelDataSize(image.width, image.height, image.format);
+	asset->entry.width = image.width;
+	asset->entry.height = image.height;
+	asset->entry.format = image.format;
+	asset->data = image.data;
+	return true;
+}
+
+// raylib only encodes QOA to a file, so this goes through one next to the pack
+static bool packAudio(PackedAsset *asset, char const *path, char const *pack_path)
+{
+	// Cut short, it would name some other file to overwrite and delete
+	char qoa_path[4096];
+	int qoa_path_length = snprintf(qoa_path, sizeof qoa_path, "%s.%s.qoa", pack_path, asset->entry.name);
+	if (qoa_path_length < 0 || (size_t) qoa_path_length >= sizeof qoa_path)
+		return false;
+
+	Wave wave = LoadWave(path);
+	if (wave.data == NULL)
+		return false;
+
+	WaveFormat(&wave, wave.sampleRate, 16, wave.channels); // All QOA takes
+	bool is_exported = ExportWave(wave, qoa_path);
+	UnloadWave(wave);
+	if (!is_exported)
+		return false;
+
+	int size = 0;
+	asset->data = LoadFileData(qoa_path, &size);
+	remove(qoa_path);
+	if (asset->data == NULL)
+		return false;
+
+	asset->entry.type = ASSET_PACK_AUDIO;
+	asset->entry.size = size;
+	strncpy(asset->entry.file_type, ".qoa", ASSET_PACK_FILE_TYPE_SIZE);
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3 || argc - 2 > PACK_MAXIMUM_ENTRIES_COUNT) {
+		fprintf(stderr, "usage: citadel-pack <pack> <asset>... (up to %u assets)\n", PACK_MAXIMUM_ENTRIES_COUNT);
+		return 1;
+	}
+
+	SetTraceLogLevel(LOG_WARNING);
+
+	char const *pack_path = argv[1];
+	PackedAsset assets[PACK_MAXIMUM_ENTRIES_COUNT] = {};
+	uint16_t assets_count = argc - 2;
+
+	for (uint16_t i = 0; i < assets_count; i++) {
+		char const *path = argv[i + 2];
+		strncpy(assets[i].entry.name, GetFileNameWithoutExt(path), ASSET_PACK_NAME_SIZE - 1);
+
+		bool is_packed;
+		if (IsFileExtension(path, ".png"))
+			is_packed = packImage(&assets[i], path);
+		else if (IsFileExtension(path, ".mp3;.ogg;.wav;.flac"))
+			is_packed = packAudio(&assets[i], path, pack_path);
+		else
+			is_packed = false;
+
+		if (!is_packed) {
+			fprintf(stderr, "citadel-pack: can't pack %s\n", path);
+			return 1;
+		}
+	}
+
+	size_t offset = alignPackOffset(sizeof (AssetPackHeader) + assets_count * sizeof (AssetPackEntry));
+	for (uint16_t i = 0; i < assets_count; i++) {
+		assets[i].entry.offset = offset;
+		offset = alignPackOffset(offset + assets[i].entry.size);
+	}
+
+	AssetPackHeader header = {
+		.magic = ASSET_PACK_MAGIC,
+		.version = ASSET_PACK_VERSION,
+		.entries_count = assets_count,
+		.file_size = offset,
+	};
+
+	// Assembled in memory first, padding zeroed, so the same assets always give the same pack
+	uint8_t *image = calloc(1, header.file_size);
+	if (image == NULL)
+		return 1;
+
+	memcpy(image, &header, sizeof header);
+	for (uint16_t i = 0; i < assets_count; i++) {
+		memcpy(image + sizeof header + i * sizeof (AssetPackEntry), &assets[i].entry, sizeof (AssetPackEntry));
+		memcpy(image + assets[i].entry.offset, assets[i].data, assets[i].entry.size);
+
+		if (assets[i].entry.type == ASSET_PACK_IMAGE) {
+			printf("%-24s %ux%u RGBA8, %llu bytes\n", assets[i].entry.name, assets[i].entry.width, assets[i].entry.height, (unsigned long long) assets[i].entry.size);
+			UnloadImage((Image) {.data = assets[i].data});
+		} else {
+			printf("%-24s QOA, %llu bytes\n", assets[i].entry.name, (unsigned long long) assets[i].entry.size);
+			UnloadFileData(assets[i].data);
+		}
+	}
+
+	FILE *file = fopen(pack_path, "wb");
+	bool is_written = file != NULL && fwrite(image, header.file_size, 1, file) == 1;
+	if (file != NULL && fclose(file) != 0)
+		is_written = false;
+	free(image);
+
+	if (!is_written) {
+		fprintf(stderr, "citadel-pack: can't write %s\n", pack_path);
+		return 1;
+	}
+	return 0;
+}